@@ -0,0 +1,664 @@
+// Micro and macro benchmarks for the public SqliteCpp operations. Every benchmark runs against an in-memory
+// and an on-disk database and reports throughput, latency percentiles and heap allocations per operation.
+// The JSON output is meant to be stored as a baseline and diffed against later runs.
+//
+// With --compare-raw every benchmark that has a hand-written equivalent on the bare sqlite3 C API runs that
+// too, against an identically populated database, and the wrapper's overhead ratio is reported next to it.
+//
+// usage: sqlitecpp_bench [--rows N] [--iterations N] [--filter text] [--output file.json] [--database path]
+//                        [--compare-raw 1]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <new>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../sqlite/sqlite3.h"
+
+#include "SqliteCpp.hpp"
+
+using namespace sqlitecpp;
+
+namespace {
+
+std::atomic<uint64_t> allocation_count{ 0 };
+
+}// namespace
+
+// Counting every heap allocation of the process, the wrapper's allocations per operation are a key metric
+void* operator new(std::size_t size)
+{
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+
+    if (void* memory = std::malloc(size > 0 ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+struct BenchUser
+{
+    int64_t     id;
+    std::string name;
+    std::string email;
+    double      score;
+};
+
+SQLITECPP_MAP(BenchUser, "users", id, name, email, score)
+
+namespace {
+
+// Rows per statement in SqliteCpp::upsertMany, mirrored by the raw baseline
+constexpr size_t RAW_ROWS_PER_UPSERT = 256;
+
+struct Config
+{
+    size_t                rows       = 10000;
+    size_t                iterations = 2000;
+    std::string           filter;
+    std::string           output;
+    std::filesystem::path database    = "sqlitecpp_bench.db";
+    bool                  compare_raw = false;
+};
+
+enum class Storage
+{
+    Memory,
+    Disk,
+};
+
+const char* toString(Storage storage)
+{
+    return storage == Storage::Memory ? "memory" : "disk";
+}
+
+std::vector<Migration> schema()
+{
+    return {
+        Migration(
+            "create users",
+            "CREATE TABLE users (id INTEGER PRIMARY KEY, name TEXT NOT NULL, email TEXT NOT NULL, score REAL);"
+            "CREATE INDEX users_email ON users (email);"),
+    };
+}
+
+std::map<std::string, SqliteData> makeUser(int64_t id)
+{
+    return {
+        { "id", id },
+        { "name", "user " + std::to_string(id) },
+        { "email", "user" + std::to_string(id) + "@example.com" },
+        { "score", id * 0.25 },
+    };
+}
+
+std::filesystem::path removeDatabase(const std::filesystem::path& path)
+{
+    for (const auto suffix : { "", "-wal", "-shm", "-journal" }) {
+        std::filesystem::remove(path.string() + suffix);
+    }
+    return path;
+}
+
+/**
+ * Database with a populated users table, created fresh for every benchmark so mutations do not leak into
+ * the next one. Setup is not part of the measurement.
+ */
+struct Fixture
+{
+    const Config&         config;
+    Storage               storage;
+    std::filesystem::path path;
+    SqliteCpp             database;
+
+    std::vector<std::map<std::string, SqliteData>> batch;
+    std::vector<SqliteRow>                         rows;
+
+    Fixture(const Config& config, Storage storage)
+        : config(config),
+          storage(storage),
+          path(storage == Storage::Memory ? std::filesystem::path(":memory:") : removeDatabase(config.database)),
+          database(SqliteCpp::createOrOpenDatabase(path))
+    {
+        database.runMigrations(schema());
+
+        std::vector<std::map<std::string, SqliteData>> users;
+        users.reserve(config.rows);
+        for (size_t id = 0; id < config.rows; ++id) {
+            users.push_back(makeUser(static_cast<int64_t>(id)));
+        }
+        database.upsertMany("users", users);
+    }
+
+    ~Fixture()
+    {
+        if (storage == Storage::Disk) {
+            // Close the file before deleting it
+            database = SqliteCpp::createOrOpenDatabase(":memory:");
+            removeDatabase(path);
+        }
+    }
+
+    int64_t id(size_t iteration) const
+    {
+        return static_cast<int64_t>(iteration % config.rows);
+    }
+};
+
+struct RawUser
+{
+    int64_t     id;
+    std::string name;
+    std::string email;
+    double      score;
+};
+
+RawUser makeRawUser(int64_t id)
+{
+    return RawUser{ id, "user " + std::to_string(id), "user" + std::to_string(id) + "@example.com", id * 0.25 };
+}
+
+/**
+ * The same database as Fixture, driven through the bare C API the way a careful hand-written caller would:
+ * every statement is prepared once and reset between executions.
+ */
+struct RawFixture
+{
+    const Config&         config;
+    Storage               storage;
+    std::filesystem::path path;
+    sqlite3*              database = nullptr;
+    std::vector<RawUser>  batch;
+
+    std::unordered_map<const char*, sqlite3_stmt*> statements;
+    // Owns the generated upsert texts, node addresses stay stable as statements keys
+    std::map<size_t, std::string> upsert_sql;
+
+    RawFixture(const Config& config, Storage storage)
+        : config(config),
+          storage(storage),
+          path(storage == Storage::Memory ? std::filesystem::path(":memory:") : removeDatabase(config.database))
+    {
+        sqlite3_open_v2(path.string().c_str(), &database, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, nullptr);
+        execute("PRAGMA foreign_keys = ON;");
+        execute(schema().front().getMigration().c_str());
+
+        sqlite3_stmt* insert = nullptr;
+        sqlite3_prepare_v2(database, "INSERT INTO users (id, name, email, score) VALUES (?, ?, ?, ?)", -1, &insert, nullptr);
+
+        execute("BEGIN;");
+        for (size_t id = 0; id < config.rows; ++id) {
+            const auto user = makeRawUser(static_cast<int64_t>(id));
+            bindUser(insert, user);
+            step(insert);
+        }
+        execute("COMMIT;");
+        sqlite3_finalize(insert);
+
+        for (int64_t id = 0; id < 1000; ++id) {
+            batch.push_back(makeRawUser(id));
+        }
+    }
+
+    ~RawFixture()
+    {
+        for (const auto& [sql, prepared] : statements) {
+            sqlite3_finalize(prepared);
+        }
+        sqlite3_close(database);
+
+        if (storage == Storage::Disk) {
+            removeDatabase(path);
+        }
+    }
+
+    // Keyed by the literal's address, every call site passes the same literal
+    sqlite3_stmt* statement(const char* sql)
+    {
+        auto& prepared = statements[sql];
+        if (prepared == nullptr) {
+            sqlite3_prepare_v2(database, sql, -1, &prepared, nullptr);
+        }
+        return prepared;
+    }
+
+    void execute(const char* sql)
+    {
+        sqlite3_exec(database, sql, nullptr, nullptr, nullptr);
+    }
+
+    // Multi-row upsert in the shape SqliteCpp::upsertMany sends, one statement per row count
+    sqlite3_stmt* upsertStatement(size_t row_count)
+    {
+        auto& sql = upsert_sql[row_count];
+        if (sql.empty()) {
+            sql = "INSERT INTO users (id, name, email, score) VALUES ";
+            for (size_t i = 0; i < row_count; ++i) {
+                sql += (i == 0 ? "(?, ?, ?, ?)" : ", (?, ?, ?, ?)");
+            }
+            sql += " ON CONFLICT (id) DO UPDATE SET name = excluded.name, email = excluded.email, score = excluded.score";
+        }
+        return statement(sql.c_str());
+    }
+
+    static void bindUser(sqlite3_stmt* prepared, const RawUser& user, int first_index = 1)
+    {
+        sqlite3_bind_int64(prepared, first_index, user.id);
+        sqlite3_bind_text(prepared, first_index + 1, user.name.data(), static_cast<int>(user.name.size()), SQLITE_STATIC);
+        sqlite3_bind_text(prepared, first_index + 2, user.email.data(), static_cast<int>(user.email.size()), SQLITE_STATIC);
+        sqlite3_bind_double(prepared, first_index + 3, user.score);
+    }
+
+    static void step(sqlite3_stmt* prepared)
+    {
+        while (sqlite3_step(prepared) == SQLITE_ROW) {
+        }
+        sqlite3_reset(prepared);
+    }
+
+    int64_t id(size_t iteration) const
+    {
+        return static_cast<int64_t>(iteration % config.rows);
+    }
+};
+
+using RawOperation = std::function<void(RawFixture&, size_t iteration)>;
+
+struct Benchmark
+{
+    std::string name;
+    // Rows touched per operation, used for rows/s; 0 means the whole table
+    size_t rows_per_operation;
+    // Macro benchmarks run iterations / divisor operations
+    size_t                                          iteration_divisor;
+    std::function<void(Fixture&)>                   setup;
+    std::function<void(Fixture&, size_t iteration)> operation;
+};
+
+struct Result
+{
+    std::string name;
+    Storage     storage;
+    size_t      operations;
+    size_t      rows_per_operation;
+    double      total_ns;
+    double      p50_ns;
+    double      p99_ns;
+    double      allocations_per_operation;
+
+    std::optional<double> raw_ns_per_operation;
+};
+
+double percentile(std::vector<double>& samples, double fraction)
+{
+    const auto position = static_cast<size_t>(fraction * (samples.size() - 1));
+    std::nth_element(samples.begin(), samples.begin() + position, samples.end());
+    return samples[position];
+}
+
+// Keeps the optimizer from discarding reads. Written as a plain store, compound assignment to a volatile is
+// deprecated in C++20.
+volatile int64_t sink = 0;
+
+void consume(int64_t value)
+{
+    sink = sink + value;
+}
+
+std::vector<Benchmark> benchmarks()
+{
+    static constexpr auto FIND_USER = sql::select("users", sql::columns("id", "name", "email", "score"), sql::where("id"));
+
+    return {
+        { "upsert/insert", 1, 1, nullptr,
+          [](Fixture& fixture, size_t iteration) {
+              fixture.database.upsert("users", makeUser(static_cast<int64_t>(fixture.config.rows + iteration)));
+          } },
+        { "upsert/update", 1, 1, nullptr,
+          [](Fixture& fixture, size_t iteration) {
+              fixture.database.upsert("users", makeUser(fixture.id(iteration)), { "id" });
+          } },
+        { "upsertMany/1000", 1000, 50,
+          [](Fixture& fixture) {
+              for (int64_t id = 0; id < 1000; ++id) {
+                  fixture.batch.push_back(makeUser(id));
+              }
+          },
+          [](Fixture& fixture, size_t) { fixture.database.upsertMany("users", fixture.batch, { "id" }); } },
+        { "selectFromTableWhere/point", 1, 1, nullptr,
+          [](Fixture& fixture, size_t iteration) {
+              const auto rows = fixture.database.selectFromTableWhere("users", { "*" }, { { "id", fixture.id(iteration) } });
+              consume(static_cast<int64_t>(rows.size()));
+          } },
+        { "selectStarFromTable", 0, 200, nullptr,
+          [](Fixture& fixture, size_t) { consume(static_cast<int64_t>(fixture.database.selectStarFromTable("users").size())); } },
+        { "cursorFromTableWhere/scan", 0, 200, nullptr,
+          [](Fixture& fixture, size_t) {
+              auto       cursor = fixture.database.cursorFromTableWhere("users", { "id", "score" });
+              const auto score = cursor.column("score");
+              for (const auto& row : cursor) {
+                  consume(static_cast<int64_t>(row.get<double>(score)));
+              }
+          } },
+        { "resultSetFromTableWhere/scan", 0, 200, nullptr,
+          [](Fixture& fixture, size_t) {
+              const auto result = fixture.database.resultSetFromTableWhere("users", { "id", "name" });
+              const auto name   = result.column("name");
+              for (const auto row : result) {
+                  consume(static_cast<int64_t>(row.get<std::string_view>(name).size()));
+              }
+          } },
+        { "select<T>/point", 1, 1, nullptr,
+          [](Fixture& fixture, size_t iteration) {
+              consume(static_cast<int64_t>(fixture.database.select<BenchUser>({ { "id", fixture.id(iteration) } }).size()));
+          } },
+        { "query/point", 1, 1, nullptr,
+          [](Fixture& fixture, size_t iteration) {
+              for (const auto& row : fixture.database.query(FIND_USER, fixture.id(iteration))) {
+                  consume(row.get<int64_t>(0));
+              }
+          } },
+        { "deleteFrom/point", 1, 1, nullptr,
+          [](Fixture& fixture, size_t iteration) {
+              fixture.database.deleteFrom("users", { { "id", fixture.id(iteration) } });
+          } },
+        { "runMigrations/applied", 0, 1, nullptr,
+          [](Fixture& fixture, size_t) { fixture.database.runMigrations(schema()); } },
+        { "SqliteRow::get/name", 1, 1,
+          [](Fixture& fixture) { fixture.rows = fixture.database.selectStarFromTable("users"); },
+          [](Fixture& fixture, size_t iteration) {
+              const auto& row = fixture.rows[iteration % fixture.rows.size()];
+              consume(row.get<int64_t>("id") + static_cast<int64_t>(row.get<std::string>("email").size()));
+          } },
+        { "SqliteRow::get/handle", 1, 1,
+          [](Fixture& fixture) { fixture.rows = fixture.database.selectStarFromTable("users"); },
+          [](Fixture& fixture, size_t iteration) {
+              const auto& row   = fixture.rows[iteration % fixture.rows.size()];
+              const auto  id    = row.header().handle("id");
+              const auto  email = row.header().handle("email");
+              consume(row.get<int64_t>(id) + static_cast<int64_t>(row.get<std::string>(email).size()));
+          } },
+    };
+}
+
+// Reads every column of the current row without copying, the cheapest possible consumer
+void consumeRow(sqlite3_stmt* prepared)
+{
+    for (int column = 0; column < sqlite3_column_count(prepared); ++column) {
+        if (sqlite3_column_type(prepared, column) == SQLITE_TEXT) {
+            consume(sqlite3_column_bytes(prepared, column));
+        } else {
+            consume(sqlite3_column_int64(prepared, column));
+        }
+    }
+}
+
+void rawPointSelect(RawFixture& fixture, size_t iteration)
+{
+    auto prepared = fixture.statement("SELECT id, name, email, score FROM users WHERE id = ?");
+    sqlite3_bind_int64(prepared, 1, fixture.id(iteration));
+    while (sqlite3_step(prepared) == SQLITE_ROW) {
+        consumeRow(prepared);
+    }
+    sqlite3_reset(prepared);
+}
+
+// Scans read the same columns as their wrapper counterparts
+RawOperation rawScan(const char* sql)
+{
+    return [sql](RawFixture& fixture, size_t) {
+        auto prepared = fixture.statement(sql);
+        while (sqlite3_step(prepared) == SQLITE_ROW) {
+            consumeRow(prepared);
+        }
+        sqlite3_reset(prepared);
+    };
+}
+
+// Hand-written equivalents keyed by benchmark name. Pure wrapper operations such as SqliteRow::get have none.
+std::unordered_map<std::string, RawOperation> rawOperations()
+{
+    return {
+        { "upsert/insert",
+          [](RawFixture& fixture, size_t iteration) {
+              auto       prepared = fixture.statement("INSERT OR REPLACE INTO users (id, name, email, score) VALUES (?, ?, ?, ?)");
+              const auto user     = makeRawUser(static_cast<int64_t>(fixture.config.rows + iteration));
+              RawFixture::bindUser(prepared, user);
+              RawFixture::step(prepared);
+          } },
+        { "upsert/update",
+          [](RawFixture& fixture, size_t iteration) {
+              auto prepared = fixture.statement(
+                  "INSERT INTO users (id, name, email, score) VALUES (?, ?, ?, ?) ON CONFLICT (id) DO UPDATE SET "
+                  "name = excluded.name, email = excluded.email, score = excluded.score");
+              const auto user = makeRawUser(fixture.id(iteration));
+              RawFixture::bindUser(prepared, user);
+              RawFixture::step(prepared);
+          } },
+        { "upsertMany/1000",
+          [](RawFixture& fixture, size_t) {
+              const auto& batch = fixture.batch;
+              fixture.execute("BEGIN;");
+              for (size_t first_row = 0; first_row < batch.size(); first_row += RAW_ROWS_PER_UPSERT) {
+                  const auto row_count = std::min(RAW_ROWS_PER_UPSERT, batch.size() - first_row);
+                  auto       prepared  = fixture.upsertStatement(row_count);
+                  for (size_t i = 0; i < row_count; ++i) {
+                      RawFixture::bindUser(prepared, batch[first_row + i], static_cast<int>(i * 4 + 1));
+                  }
+                  RawFixture::step(prepared);
+              }
+              fixture.execute("COMMIT;");
+          } },
+        { "selectFromTableWhere/point", rawPointSelect },
+        { "select<T>/point", rawPointSelect },
+        { "query/point", rawPointSelect },
+        { "selectStarFromTable", rawScan("SELECT * FROM users") },
+        { "cursorFromTableWhere/scan", rawScan("SELECT id, score FROM users") },
+        { "resultSetFromTableWhere/scan", rawScan("SELECT id, name FROM users") },
+        { "deleteFrom/point",
+          [](RawFixture& fixture, size_t iteration) {
+              auto prepared = fixture.statement("DELETE FROM users WHERE id = ?");
+              sqlite3_bind_int64(prepared, 1, fixture.id(iteration));
+              RawFixture::step(prepared);
+          } },
+    };
+}
+
+struct Measurement
+{
+    std::vector<double> latencies;
+    uint64_t            allocations = 0;
+};
+
+template<typename Fixture, typename Operation>
+Measurement measure(Fixture& fixture, const Operation& operation, size_t operations)
+{
+    // One untimed round trip warms the statement cache and the page cache
+    operation(fixture, 0);
+
+    Measurement measurement;
+    measurement.latencies.reserve(operations);
+
+    const auto allocations_before = allocation_count.load();
+    for (size_t iteration = 1; iteration <= operations; ++iteration) {
+        const auto start = std::chrono::steady_clock::now();
+        operation(fixture, iteration);
+        measurement.latencies.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+    }
+    measurement.allocations = allocation_count.load() - allocations_before;
+
+    return measurement;
+}
+
+double sum(const std::vector<double>& samples)
+{
+    double total = 0;
+    for (const auto sample : samples) {
+        total += sample;
+    }
+    return total;
+}
+
+Result run(const Config& config, const Benchmark& benchmark, const RawOperation* raw_operation, Storage storage)
+{
+    const size_t operations = std::max<size_t>(1, config.iterations / benchmark.iteration_divisor);
+
+    Measurement measurement;
+    {
+        Fixture fixture(config, storage);
+        if (benchmark.setup) {
+            benchmark.setup(fixture);
+        }
+        measurement = measure(fixture, benchmark.operation, operations);
+    }
+
+    Result result;
+    result.name                      = benchmark.name;
+    result.storage                   = storage;
+    result.operations                = operations;
+    result.rows_per_operation        = benchmark.rows_per_operation > 0 ? benchmark.rows_per_operation : config.rows;
+    result.total_ns                  = sum(measurement.latencies);
+    result.allocations_per_operation = static_cast<double>(measurement.allocations) / operations;
+    result.p50_ns                    = percentile(measurement.latencies, 0.50);
+    result.p99_ns                    = percentile(measurement.latencies, 0.99);
+
+    if (raw_operation != nullptr) {
+        RawFixture raw_fixture(config, storage);
+        result.raw_ns_per_operation = sum(measure(raw_fixture, *raw_operation, operations).latencies) / operations;
+    }
+
+    return result;
+}
+
+std::string toJson(const Config& config, const std::vector<Result>& results)
+{
+    std::ostringstream json;
+    json.precision(6);
+    json << std::fixed;
+
+    json << "{\n  \"config\": {\"rows\": " << config.rows << ", \"iterations\": " << config.iterations << "},\n";
+    json << "  \"results\": [\n";
+
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto&  result    = results[i];
+        const double ns_per_op = result.total_ns / result.operations;
+        const double ops_per_s = 1e9 / ns_per_op;
+
+        json << "    {\"name\": \"" << result.name << "\", \"storage\": \"" << toString(result.storage) << "\""
+             << ", \"operations\": " << result.operations << ", \"ns_per_op\": " << ns_per_op
+             << ", \"ops_per_sec\": " << ops_per_s << ", \"rows_per_sec\": " << ops_per_s * result.rows_per_operation
+             << ", \"p50_ns\": " << result.p50_ns << ", \"p99_ns\": " << result.p99_ns
+             << ", \"allocations_per_op\": " << result.allocations_per_operation;
+
+        if (result.raw_ns_per_operation) {
+            json << ", \"raw_ns_per_op\": " << *result.raw_ns_per_operation
+                 << ", \"overhead_ratio\": " << ns_per_op / *result.raw_ns_per_operation;
+        }
+
+        json << "}"
+             << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+
+    json << "  ]\n}\n";
+    return json.str();
+}
+
+Config parseArguments(int argc, char** argv)
+{
+    Config config;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string flag  = argv[i];
+        const std::string value = argv[i + 1];
+
+        if (flag == "--rows") {
+            config.rows = std::max<size_t>(1, std::stoul(value));
+        } else if (flag == "--iterations") {
+            config.iterations = std::max<size_t>(1, std::stoul(value));
+        } else if (flag == "--filter") {
+            config.filter = value;
+        } else if (flag == "--output") {
+            config.output = value;
+        } else if (flag == "--database") {
+            config.database = value;
+        } else if (flag == "--compare-raw") {
+            config.compare_raw = value != "0";
+        } else {
+            throw std::invalid_argument("Unknown argument " + flag);
+        }
+    }
+
+    return config;
+}
+
+}// namespace
+
+int main(int argc, char** argv)
+{
+    const auto config = parseArguments(argc, argv);
+
+    const auto          raw_operations = rawOperations();
+    std::vector<Result> results;
+
+    for (const auto& benchmark : benchmarks()) {
+        if (benchmark.name.find(config.filter) == std::string::npos) {
+            continue;
+        }
+
+        const auto raw_operation = config.compare_raw ? raw_operations.find(benchmark.name) : raw_operations.end();
+
+        for (const auto storage : { Storage::Memory, Storage::Disk }) {
+            const auto& result = results.emplace_back(
+                run(config, benchmark, raw_operation != raw_operations.end() ? &raw_operation->second : nullptr, storage));
+
+            std::fprintf(
+                stderr,
+                "%-32s %-6s %12.0f ns/op %12.0f p50 %12.0f p99 %10.1f allocs/op",
+                result.name.c_str(),
+                toString(result.storage),
+                result.total_ns / result.operations,
+                result.p50_ns,
+                result.p99_ns,
+                result.allocations_per_operation);
+
+            if (result.raw_ns_per_operation) {
+                const auto ratio = result.total_ns / result.operations / *result.raw_ns_per_operation;
+                std::fprintf(stderr, " %12.0f raw ns/op %8.2fx overhead", *result.raw_ns_per_operation, ratio);
+            }
+            std::fprintf(stderr, "\n");
+        }
+    }
+
+    const auto json = toJson(config, results);
+    if (config.output.empty()) {
+        std::cout << json;
+    } else {
+        std::ofstream(config.output) << json;
+    }
+
+    return 0;
+}
@@ -0,0 +1,137 @@
+// Compares INSERT OR REPLACE with ON CONFLICT DO UPDATE on a wide, heavily indexed table whose rows are
+// referenced by an ON DELETE CASCADE foreign key.
+//
+// usage: sqlitecpp_upsert_bench [row_count] [database_path]
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "SqliteCpp.hpp"
+
+using namespace sqlitecpp;
+
+namespace {
+
+constexpr int INDEXED_COLUMNS = 8;
+constexpr int PLAIN_COLUMNS   = 8;
+
+std::string columnName(int column)
+{
+    return "c" + std::to_string(column);
+}
+
+std::vector<Migration> schema()
+{
+    std::string wide = "CREATE TABLE wide (id INTEGER PRIMARY KEY, key TEXT NOT NULL UNIQUE";
+    for (int column = 0; column < INDEXED_COLUMNS + PLAIN_COLUMNS; ++column) {
+        wide += ", " + columnName(column) + " INTEGER";
+    }
+    wide += ");";
+
+    for (int column = 0; column < INDEXED_COLUMNS; ++column) {
+        wide += "CREATE INDEX wide_" + columnName(column) + " ON wide (" + columnName(column) + ");";
+    }
+
+    return {
+        Migration("create wide", wide),
+        Migration(
+            "create child",
+            "CREATE TABLE child (id INTEGER PRIMARY KEY, wide_id INTEGER NOT NULL REFERENCES wide (id) ON DELETE CASCADE);"),
+    };
+}
+
+std::vector<std::map<std::string, SqliteData>> makeRows(int row_count, int generation)
+{
+    std::vector<std::map<std::string, SqliteData>> rows;
+    rows.reserve(row_count);
+
+    for (int i = 0; i < row_count; ++i) {
+        std::map<std::string, SqliteData> row{ { "key", "key-" + std::to_string(i) } };
+
+        // Indexed columns keep their values, only the plain payload columns change between generations
+        for (int column = 0; column < INDEXED_COLUMNS; ++column) {
+            row[columnName(column)] = i * 31 + column;
+        }
+        for (int column = INDEXED_COLUMNS; column < INDEXED_COLUMNS + PLAIN_COLUMNS; ++column) {
+            row[columnName(column)] = i + generation * 1000 + column;
+        }
+
+        rows.push_back(std::move(row));
+    }
+
+    return rows;
+}
+
+// Bytes handed to write(2) by this process, the closest portable-enough proxy for write amplification
+long long writtenBytes()
+{
+    std::ifstream io("/proc/self/io");
+    std::string   key;
+    long long     value;
+
+    while (io >> key >> value) {
+        if (key == "wchar:") {
+            return value;
+        }
+    }
+    return -1;
+}
+
+void run(const std::string& label, const std::filesystem::path& db_path, int row_count, const std::vector<std::string>& conflict_columns)
+{
+    std::filesystem::remove(db_path);
+
+    auto db = SqliteCpp::createOrOpenDatabase(db_path);
+    db.runMigrations(schema());
+    db.upsertMany("wide", makeRows(row_count, 0));
+
+    std::vector<std::map<std::string, SqliteData>> children;
+    for (const auto& row : db.cursorFromTableWhere("wide", { "id" })) {
+        children.push_back({ { "wide_id", row.get<int>("id") } });
+    }
+    db.upsertMany("child", children);
+
+    const auto max_id_before = db.selectFromTableWhere("wide", { "MAX(id) AS id" }).front().get<int64_t>("id");
+    const auto updated_rows  = makeRows(row_count, 1);
+
+    const auto bytes_before = writtenBytes();
+    const auto start        = std::chrono::steady_clock::now();
+
+    db.upsertMany("wide", updated_rows, conflict_columns);
+
+    const auto elapsed     = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const auto bytes_after = writtenBytes();
+
+    const auto max_id_after   = db.selectFromTableWhere("wide", { "MAX(id) AS id" }).front().get<int64_t>("id");
+    const auto children_after = db.selectFromTableWhere("child", { "COUNT(*) AS n" }).front().get<int64_t>("n");
+
+    std::printf(
+        "%-24s %10.3f ms %12.0f rows/s %12lld bytes written %8lld rowids moved %8lld/%zu children kept\n",
+        label.c_str(),
+        elapsed * 1000.0,
+        row_count / elapsed,
+        bytes_before < 0 ? -1 : bytes_after - bytes_before,
+        static_cast<long long>(max_id_after - max_id_before),
+        static_cast<long long>(children_after),
+        children.size());
+
+    std::filesystem::remove(db_path);
+}
+
+}// namespace
+
+int main(int argc, char** argv)
+{
+    const int                   row_count = argc > 1 ? std::stoi(argv[1]) : 20000;
+    const std::filesystem::path db_path   = argc > 2 ? argv[2] : "sqlitecpp_upsert_bench.db";
+
+    std::printf("%d rows, %d indexed + %d plain columns\n", row_count, INDEXED_COLUMNS, PLAIN_COLUMNS);
+
+    run("INSERT OR REPLACE", db_path, row_count, {});
+    run("ON CONFLICT DO UPDATE", db_path, row_count, { "key" });
+
+    return 0;
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <filesystem>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "SqliteCpp.hpp"
+
+namespace sqlitecpp {
+
+/**
+ * Runs a connection on a dedicated worker thread so callers never block on disk I/O. Requests are pushed onto
+ * a lock-free multi-producer queue and answered through futures. The worker drains the queue in batches and
+ * merges consecutive writes into one transaction, each write in its own savepoint so a failing write does not
+ * take the others with it. Write futures become ready once the batch is committed.
+ *
+ * Arguments are copied into the request, except for SqliteTextView and SqliteBlobView data, which has to
+ * stay alive until the future is ready. Pending requests are still executed when the executor is destroyed.
+ */
+class AsyncSqliteCpp
+{
+public:
+    static constexpr size_t DEFAULT_MAX_BATCH = 64;
+
+    explicit AsyncSqliteCpp(
+        const std::filesystem::path& db_path,
+        const OpenOptions&           options   = OpenOptions::oltpDurable(),
+        size_t                       max_batch = DEFAULT_MAX_BATCH);
+
+                    AsyncSqliteCpp(const AsyncSqliteCpp&) = delete;
+    AsyncSqliteCpp& operator=(const AsyncSqliteCpp&) = delete;
+
+    ~AsyncSqliteCpp();
+
+    std::future<std::vector<SqliteRow>> selectFromTableWhere(
+        std::string                       table,
+        std::vector<std::string>          columns       = { "*" },
+        std::map<std::string, SqliteData> where_clauses = {});
+    std::future<void> upsert(
+        std::string                       table,
+        std::map<std::string, SqliteData> column_to_data,
+        std::vector<std::string>          conflict_columns = {});
+    std::future<void> deleteFrom(std::string table, std::map<std::string, SqliteData> where_clauses);
+
+    // Runs function(SqliteCpp&) on the worker inside a transaction and returns its result
+    template<typename Function>
+    auto transaction(Function function) -> std::future<std::invoke_result_t<Function&, SqliteCpp&>>;
+
+private:
+    class Task
+    {
+    public:
+        explicit Task(bool is_write) : is_write(is_write)
+        {
+        }
+
+        virtual ~Task() = default;
+
+        // run stores the result, which is only published by complete once the surrounding batch is durable
+        virtual void run(SqliteCpp& database)       = 0;
+        virtual void complete()                     = 0;
+        virtual void fail(std::exception_ptr error) = 0;
+
+        const bool is_write;
+    };
+
+    template<typename Function>
+    class FunctionTask;
+
+    struct Node;
+
+    SqliteCpp database_;
+    size_t    max_batch_;
+
+    // Producers swap themselves in at head_, the worker consumes from tail_, which always points at a spent node
+    std::atomic<Node*> head_;
+    Node*              tail_;
+
+    std::mutex              mutex_;
+    std::condition_variable wake_;
+    std::atomic<bool>       sleeping_{ false };
+    std::atomic<bool>       stopping_{ false };
+    std::thread             worker_;
+
+    template<typename Function>
+    auto submit(bool is_write, Function function) -> std::future<std::invoke_result_t<Function&, SqliteCpp&>>;
+
+    void                  push(std::unique_ptr<Task> task);
+    std::unique_ptr<Task> pop();
+    bool                  isEmpty() const;
+
+    void run();
+    void waitForWork();
+    void execute(std::vector<std::unique_ptr<Task>>& batch);
+    void executeWrites(std::vector<std::unique_ptr<Task>>::iterator first, std::vector<std::unique_ptr<Task>>::iterator last);
+};
+
+template<typename Function>
+class AsyncSqliteCpp::FunctionTask : public Task
+{
+public:
+    using Result = std::invoke_result_t<Function&, SqliteCpp&>;
+
+    FunctionTask(bool is_write, Function function) : Task(is_write), function_(std::move(function))
+    {
+    }
+
+    std::future<Result> future()
+    {
+        return promise_.get_future();
+    }
+
+    void run(SqliteCpp& database) override
+    {
+        if constexpr (std::is_void_v<Result>) {
+            function_(database);
+        } else {
+            result_.emplace(function_(database));
+        }
+    }
+
+    void complete() override
+    {
+        if constexpr (std::is_void_v<Result>) {
+            promise_.set_value();
+        } else {
+            promise_.set_value(std::move(*result_));
+        }
+    }
+
+    void fail(std::exception_ptr error) override
+    {
+        promise_.set_exception(std::move(error));
+    }
+
+private:
+    using Storage = std::conditional_t<std::is_void_v<Result>, bool, std::optional<Result>>;
+
+    Function             function_;
+    std::promise<Result> promise_;
+    Storage              result_{};
+};
+
+template<typename Function>
+auto AsyncSqliteCpp::transaction(Function function) -> std::future<std::invoke_result_t<Function&, SqliteCpp&>>
+{
+    return submit(true, std::move(function));
+}
+
+template<typename Function>
+auto AsyncSqliteCpp::submit(bool is_write, Function function) -> std::future<std::invoke_result_t<Function&, SqliteCpp&>>
+{
+    auto task   = std::make_unique<FunctionTask<Function>>(is_write, std::move(function));
+    auto future = task->future();
+    push(std::move(task));
+    return future;
+}
+
+}// namespace sqlitecpp
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+struct sqlite3_blob;
+
+namespace sqlitecpp {
+
+class SqliteCpp;
+
+/**
+ * Incremental access to a single BLOB cell addressed by (table, column, rowid), so large payloads can be read
+ * and written in chunks instead of being materialized. The size of a blob cannot change through the stream;
+ * preallocate it by writing a SqliteZeroBlob first. A stream must not outlive its SqliteCpp.
+ */
+class BlobStream
+{
+public:
+                BlobStream(BlobStream&& other) noexcept;
+    BlobStream& operator=(BlobStream&& other) noexcept;
+                BlobStream(const BlobStream&) = delete;
+    BlobStream& operator=(const BlobStream&) = delete;
+
+    ~BlobStream();
+
+    size_t size() const;
+    bool   isWritable() const;
+
+    // Sequential access from the current position, read returns the number of bytes copied (0 at the end)
+    size_t read(std::byte* buffer, size_t count);
+    void   write(const std::byte* data, size_t count);
+    size_t tell() const;
+    void   seek(size_t position);
+
+    // Random access, throws if the range is not inside the blob
+    void readAt(size_t offset, std::byte* buffer, size_t count) const;
+    void writeAt(size_t offset, const std::byte* data, size_t count);
+
+    // Moves the stream to the same column of another row and rewinds it
+    void reopen(int64_t rowid);
+    void close();
+
+private:
+    friend class SqliteCpp;
+
+    BlobStream(sqlite3_blob* blob, bool writable);
+
+    sqlite3_blob* blob_;
+    bool          writable_;
+    size_t        size_;
+    size_t        position_ = 0;
+
+    void guardRange(size_t offset, size_t count) const;
+};
+
+}// namespace sqlitecpp
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "SqliteData.hpp"
+
+namespace sqlitecpp::detail {
+
+template<typename T>
+struct IsOptional : std::false_type
+{
+};
+
+template<typename T>
+struct IsOptional<std::optional<T>> : std::true_type
+{
+};
+
+template<typename T>
+constexpr bool ALWAYS_FALSE = false;
+
+enum class CellType : uint8_t
+{
+    Null,
+    Integer,
+    Real,
+    Text,
+    Blob,
+};
+
+// One cell as SqliteRow, ResultSet::Row and RowView hand it to convertCell; text and blob bytes are borrowed
+struct CellValue
+{
+    CellType         type    = CellType::Null;
+    int64_t          integer = 0;
+    double           real    = 0;
+    std::string_view bytes;
+};
+
+[[noreturn]] void throwNullValue();
+
+int64_t          toInteger(const CellValue& cell);
+double           toDouble(const CellValue& cell);
+bool             toBool(const CellValue& cell);
+std::string      toText(const CellValue& cell);
+// Text and blob bytes only; numbers have no bytes to point into, read them with toText
+std::string_view toBytes(const CellValue& cell);
+// Copies text and blob bytes, numbers as their text
+std::vector<std::byte> toByteVector(const CellValue& cell);
+
+// The conversions behind every row type's get<T>: NULL becomes std::nullopt for optionals and throws otherwise
+template<typename T>
+T convertCell(const CellValue& cell)
+{
+    if constexpr (IsOptional<T>::value) {
+        if (cell.type == CellType::Null) {
+            return std::nullopt;
+        }
+        return convertCell<typename T::value_type>(cell);
+    } else {
+        if (cell.type == CellType::Null) {
+            throwNullValue();
+        }
+
+        if constexpr (std::is_same_v<T, bool>) {
+            return toBool(cell);
+        } else if constexpr (std::is_integral_v<T>) {
+            return static_cast<T>(toInteger(cell));
+        } else if constexpr (std::is_floating_point_v<T>) {
+            return static_cast<T>(toDouble(cell));
+        } else if constexpr (std::is_same_v<T, std::string>) {
+            return toText(cell);
+        } else if constexpr (std::is_same_v<T, std::string_view>) {
+            return toBytes(cell);
+        } else if constexpr (std::is_same_v<T, SqliteBlobView>) {
+            const auto bytes = toBytes(cell);
+            return SqliteBlobView{ reinterpret_cast<const std::byte*>(bytes.data()), bytes.size() };
+        } else if constexpr (std::is_same_v<T, std::vector<std::byte>>) {
+            return toByteVector(cell);
+        } else {
+            static_assert(ALWAYS_FALSE<T>, "Unsupported column type");
+        }
+    }
+}
+
+}// namespace sqlitecpp::detail
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace sqlitecpp {
+
+// Position of a column in a result, resolved once and reused for every row
+struct ColumnHandle
+{
+    size_t index;
+};
+
+/**
+ * Column names of a result set, built once per statement execution and shared by all of its rows.
+ */
+class ColumnHeader
+{
+public:
+    explicit ColumnHeader(std::vector<std::string> names);
+
+    size_t             size() const;
+    const std::string& name(size_t index) const;
+    ColumnHandle       handle(const std::string& column_name) const;
+    bool               contains(const std::string& column_name) const;
+
+private:
+    std::vector<std::string>                names_;
+    std::unordered_map<std::string, size_t> indices_;
+};
+
+}// namespace sqlitecpp
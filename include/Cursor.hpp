@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <string>
+
+#include "SqliteRow.hpp"
+#include "StatementCache.hpp"
+
+namespace sqlitecpp {
+
+/**
+ * Forward-only view over a live statement that materializes one row at a time. The yielded row is reused
+ * between steps, so copy it if it has to outlive the iteration. All rows share the cursor's column header.
+ * A cursor must not outlive its SqliteCpp.
+ */
+class Cursor
+{
+public:
+    class Iterator
+    {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type        = SqliteRow;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = const SqliteRow*;
+        using reference         = const SqliteRow&;
+
+        explicit Iterator(Cursor* cursor = nullptr);
+
+        reference operator*() const;
+        pointer   operator->() const;
+        Iterator& operator++();
+        bool      operator==(const Iterator& other) const;
+        bool      operator!=(const Iterator& other) const;
+
+    private:
+        Cursor* cursor_;
+
+        bool atEnd() const;
+    };
+
+    explicit Cursor(CachedStatement statement);
+
+            Cursor(Cursor&& other) noexcept = default;
+    Cursor& operator=(Cursor&& other) noexcept = default;
+            Cursor(const Cursor&) = delete;
+    Cursor& operator=(const Cursor&) = delete;
+
+    Iterator begin();
+    Iterator end();
+
+    bool             next();
+    const SqliteRow& row() const;
+
+    // The header is known before the first step, so handles can be resolved outside the loop
+    const ColumnHeader& header() const;
+    ColumnHandle        column(const std::string& column_name) const;
+
+private:
+    CachedStatement                     statement_;
+    std::shared_ptr<const ColumnHeader> header_;
+    SqliteRow                           row_;
+    bool                                started_ = false;
+    bool                                done_    = false;
+};
+
+}// namespace sqlitecpp
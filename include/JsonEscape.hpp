@@ -0,0 +1,11 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace sqlitecpp::detail {
+
+// Appends text as the inside of a JSON string literal: quotes, backslashes and control characters are escaped
+void appendJsonEscaped(std::string& out, std::string_view text);
+
+}// namespace sqlitecpp::detail
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <string>
+
+namespace sqlitecpp::metrics {
+
+/**
+ * Process wide latency histograms and counters for the public SqliteCpp operations. Recording only happens
+ * when the library is built with SQLITECPP_ENABLE_METRICS; otherwise every hook compiles to nothing and
+ * snapshots stay empty. Each thread records into its own shard without locks, a snapshot merges the shards.
+ */
+#ifdef SQLITECPP_ENABLE_METRICS
+constexpr bool ENABLED = true;
+#else
+constexpr bool ENABLED = false;
+#endif
+
+enum class Operation : uint8_t
+{
+    Select,
+    Upsert,
+    Delete,
+    Migration,
+    Transaction,
+    Query,// compile-time queries run through SqliteCpp::query and SqliteCpp::execute
+};
+
+constexpr size_t OPERATION_COUNT = 6;
+
+const char* toString(Operation operation);
+
+/**
+ * Log-linear (HDR style) histogram of nanosecond latencies: values below 16 ns are exact, above that each
+ * power of two is split into 16 linear sub-buckets, so every bucket is within 6.25% of its values.
+ */
+class LatencyHistogram
+{
+public:
+    static constexpr size_t SUB_BUCKET_BITS = 4;
+    static constexpr size_t SUB_BUCKETS     = size_t(1) << SUB_BUCKET_BITS;
+    static constexpr size_t MAX_EXPONENT    = 44;// 2^44 ns, about 4.9 hours; larger values land in the last bucket
+    static constexpr size_t BUCKET_COUNT    = (MAX_EXPONENT - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    static size_t   bucketIndex(uint64_t nanoseconds);
+    static uint64_t bucketUpperBound(size_t index);
+
+    void record(uint64_t nanoseconds);
+    void merge(const LatencyHistogram& other);
+
+    uint64_t                 count() const;
+    std::chrono::nanoseconds sum() const;
+    std::chrono::nanoseconds max() const;
+    // Upper bound of the bucket holding the given quantile (0.0 to 1.0)
+    std::chrono::nanoseconds percentile(double quantile) const;
+
+    const std::array<uint64_t, BUCKET_COUNT>& buckets() const;
+
+private:
+    friend struct Shard;
+
+    std::array<uint64_t, BUCKET_COUNT> buckets_{};
+    uint64_t                           count_  = 0;
+    uint64_t                           sum_ns_ = 0;
+    uint64_t                           max_ns_ = 0;
+};
+
+struct OperationStats
+{
+    uint64_t         calls  = 0;
+    uint64_t         errors = 0;// calls that threw or transactions that were rolled back
+    uint64_t         rows   = 0;
+    uint64_t         bytes  = 0;// text and blob bytes bound or read
+    LatencyHistogram latency;
+};
+
+struct Snapshot
+{
+    std::array<OperationStats, OPERATION_COUNT> operations;
+
+    const OperationStats& operator[](Operation operation) const;
+};
+
+Snapshot snapshot();
+
+// Prometheus text exposition format, e.g. for the node exporter's textfile collector
+std::string toPrometheus(const Snapshot& snapshot);
+// Writes to a temporary file next to path and renames it, so scrapers never see a partial file
+void writePrometheus(const Snapshot& snapshot, const std::filesystem::path& path);
+
+void record(Operation operation, std::chrono::nanoseconds latency, bool failed, uint64_t rows, uint64_t bytes);
+
+class Stopwatch
+{
+public:
+    Stopwatch() noexcept
+    {
+        if constexpr (ENABLED) {
+            started_at_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    std::chrono::nanoseconds elapsed() const noexcept
+    {
+        if constexpr (ENABLED) {
+            return std::chrono::steady_clock::now() - started_at_;
+        }
+        return std::chrono::nanoseconds(0);
+    }
+
+private:
+    std::chrono::steady_clock::time_point started_at_{};
+};
+
+// Times the enclosing call and records it on destruction, as failed if it is left by an exception
+class Scope
+{
+public:
+    explicit Scope(Operation operation) noexcept : operation_(operation)
+    {
+        if constexpr (ENABLED) {
+            uncaught_exceptions_ = std::uncaught_exceptions();
+        }
+    }
+
+    Scope(const Scope&)            = delete;
+    Scope& operator=(const Scope&) = delete;
+
+    ~Scope()
+    {
+        if constexpr (ENABLED) {
+            record(operation_, stopwatch_.elapsed(), std::uncaught_exceptions() > uncaught_exceptions_, rows_, bytes_);
+        }
+    }
+
+    void addRows(uint64_t rows) noexcept
+    {
+        rows_ += rows;
+    }
+
+    void addBytes(uint64_t bytes) noexcept
+    {
+        bytes_ += bytes;
+    }
+
+private:
+    Operation operation_;
+    Stopwatch stopwatch_;
+    int       uncaught_exceptions_ = 0;
+    uint64_t  rows_                = 0;
+    uint64_t  bytes_               = 0;
+};
+
+}// namespace sqlitecpp::metrics
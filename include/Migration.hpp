@@ -1,5 +1,7 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
 #include <string>
 
 namespace sqlitecpp {
@@ -17,4 +19,35 @@ private:
     std::string migration_;
 };
 
+struct BackfillOptions
+{
+    int64_t                   chunk_size = 1000;      // rowids in the first chunk
+    std::chrono::milliseconds target_chunk_time{ 50 };// later chunks are halved or doubled to stay near this
+    double                    duty_cycle = 0.5;       // share of the run spent holding the write lock
+};
+
+/**
+ * Data migration run in rowid ranges with a commit per chunk, so foreground writers get the lock between
+ * chunks and the WAL can be checkpointed. The statement is executed once per chunk with the range bound to
+ * ?1 and ?2, e.g. "UPDATE users SET email_lower = lower(email) WHERE rowid BETWEEN ?1 AND ?2". Progress is
+ * committed with each chunk to sqlitecpp_backfills, an interrupted backfill resumes after the last finished
+ * chunk. Titles are separate from those of Migration.
+ */
+class BackfillMigration
+{
+public:
+    BackfillMigration(std::string title, std::string table, std::string statement, BackfillOptions options = {});
+
+    const std::string&     getTitle() const;
+    const std::string&     getTable() const;
+    const std::string&     getStatement() const;
+    const BackfillOptions& getOptions() const;
+
+private:
+    std::string     title_;
+    std::string     table_;
+    std::string     statement_;
+    BackfillOptions options_;
+};
+
 }// namespace sqlitecpp
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "QueryPlan.hpp"
+#include "SlowQueryLog.hpp"
+
+namespace sqlitecpp {
+
+enum class JournalMode
+{
+    Delete,
+    Truncate,
+    Persist,
+    Memory,
+    Wal,
+    Off,
+};
+
+enum class Synchronous
+{
+    Off,
+    Normal,
+    Full,
+    Extra,
+};
+
+enum class TempStore
+{
+    Default,
+    File,
+    Memory,
+};
+
+enum class LockingMode
+{
+    Normal,
+    Exclusive,
+};
+
+/**
+ * Connection settings applied when a database is opened. Unset options keep SQLite's defaults.
+ */
+struct OpenOptions
+{
+    bool read_only    = false;
+    bool no_mutex     = false;// SQLITE_OPEN_NOMUTEX, only for connections confined to one thread at a time
+    bool foreign_keys = true;
+
+    // Aggregate executed statements by normalized fingerprint, see SqliteCpp::topStatements
+    bool statement_stats = false;
+
+    // Run EXPLAIN QUERY PLAN for every new query shape and report full scans, temporary b-trees and automatic
+    // indexes to query_plan_handler, or to stderr without one. Meant for tests and staging, not production.
+    bool                    inspect_query_plans = false;
+    QueryPlanWarningHandler query_plan_handler;
+
+    // Log statements slower than the threshold with their expanded SQL. Busy waits are then handled by the
+    // library instead of sqlite3_busy_timeout, with the same busy_timeout_ms, so they can be reported.
+    std::optional<SlowQueryLogOptions> slow_query_log;
+
+    // Record prepares, statement executions, transactions, fsyncs and checkpoints for trace::writeChromeTrace.
+    // The database is opened through a VFS shim that times xSync, and the library runs the WAL auto-checkpoints.
+    bool trace_events = false;
+
+    std::optional<JournalMode> journal_mode;
+    std::optional<Synchronous> synchronous;
+    std::optional<int64_t>     mmap_size;      // bytes
+    std::optional<int64_t>     cache_size;     // pages if positive, KiB if negative, as in PRAGMA cache_size
+    std::optional<TempStore>   temp_store;
+    std::optional<int>         busy_timeout_ms;
+    std::optional<int>         page_size;      // only takes effect before the first table is created
+    std::optional<LockingMode> locking_mode;
+
+    // Passed as URI query parameters, e.g. { "cache", "shared" } or { "immutable", "1" }
+    std::map<std::string, std::string> uri_parameters;
+
+    // WAL with synchronous=FULL: every commit is durable, readers never block the writer
+    static OpenOptions oltpDurable();
+    // WAL with synchronous=OFF, exclusive locking and a large cache: fast, but a power loss may lose commits
+    static OpenOptions bulkLoad();
+    // Read-only connection with a large page cache and memory-mapped I/O
+    static OpenOptions readOnlyAnalytics();
+
+    int                      openFlags(bool create) const;
+    std::string              uri(const std::filesystem::path& db_path) const;
+    std::vector<std::string> pragmas() const;
+};
+
+}// namespace sqlitecpp
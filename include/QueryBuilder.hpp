@@ -0,0 +1,244 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+namespace sqlitecpp::sql {
+
+/**
+ * Compile-time SQL for fixed query shapes. The text is generated by constexpr functions into static storage
+ * and the number of parameters is part of the query's type, so SqliteCpp::query and SqliteCpp::execute can
+ * reject a wrong number of arguments at compile time:
+ *
+ *   static constexpr auto FIND_USER = sql::select("users", sql::columns("id", "name"), sql::where("id"));
+ *   for (const auto& row : db.query(FIND_USER, user_id)) { ... }
+ */
+template<size_t N>
+struct FixedString
+{
+    char data[N + 1]{};
+
+    constexpr FixedString() = default;
+
+    constexpr FixedString(const char (&text)[N + 1])
+    {
+        for (size_t i = 0; i < N; ++i) {
+            data[i] = text[i];
+        }
+    }
+
+    constexpr size_t size() const
+    {
+        return N;
+    }
+
+    constexpr std::string_view view() const
+    {
+        return std::string_view(data, N);
+    }
+};
+
+template<size_t N>
+FixedString(const char (&)[N]) -> FixedString<N - 1>;
+
+template<size_t N, size_t ParameterCount>
+struct Query
+{
+    static constexpr size_t parameter_count = ParameterCount;
+
+    FixedString<N> text;
+
+    constexpr std::string_view sql() const
+    {
+        return text.view();
+    }
+};
+
+// Comma separated column names, e.g. "id, name"
+template<size_t N, size_t Count>
+struct Columns
+{
+    static constexpr size_t count = Count;
+
+    FixedString<N> text;
+};
+
+// Equality conditions joined with AND, e.g. "id = ? AND name = ?"
+template<size_t N, size_t Count>
+struct Where
+{
+    static constexpr size_t count = Count;
+
+    FixedString<N> text;
+};
+
+namespace detail {
+
+enum class Format
+{
+    Name,    // id
+    Equals,  // id = ?
+    Excluded,// id = excluded.id
+};
+
+constexpr size_t formattedSize(size_t name_size, Format format)
+{
+    switch (format) {
+        case Format::Equals:
+            return name_size + 4;
+        case Format::Excluded:
+            return 2 * name_size + 12;
+        default:
+            return name_size;
+    }
+}
+
+template<size_t... Ns>
+constexpr size_t joinedSize(size_t separator_size, Format format)
+{
+    static_assert(sizeof...(Ns) > 0, "At least one column is required");
+    return (formattedSize(Ns - 1, format) + ...) + separator_size * (sizeof...(Ns) - 1);
+}
+
+template<size_t N>
+struct Writer
+{
+    FixedString<N> text;
+    size_t         position = 0;
+
+    constexpr void append(std::string_view part)
+    {
+        for (const char c : part) {
+            text.data[position++] = c;
+        }
+    }
+};
+
+template<size_t N, size_t Count>
+constexpr FixedString<N> join(const std::string_view (&names)[Count], std::string_view separator, Format format)
+{
+    Writer<N> writer;
+
+    for (size_t i = 0; i < Count; ++i) {
+        if (i > 0) {
+            writer.append(separator);
+        }
+
+        writer.append(names[i]);
+        if (format == Format::Equals) {
+            writer.append(" = ?");
+        } else if (format == Format::Excluded) {
+            writer.append(" = excluded.");
+            writer.append(names[i]);
+        }
+    }
+
+    return writer.text;
+}
+
+template<size_t... Ns>
+constexpr FixedString<(Ns + ...)> concat(const FixedString<Ns>&... parts)
+{
+    Writer<(Ns + ...)> writer;
+    (writer.append(parts.view()), ...);
+    return writer.text;
+}
+
+template<size_t ParameterCount, size_t N>
+constexpr Query<N, ParameterCount> makeQuery(const FixedString<N>& text)
+{
+    return Query<N, ParameterCount>{ text };
+}
+
+template<size_t Count>
+constexpr FixedString<Count * 3 - 2> placeholders()
+{
+    Writer<Count * 3 - 2> writer;
+
+    for (size_t i = 0; i < Count; ++i) {
+        writer.append(i > 0 ? ", ?" : "?");
+    }
+
+    return writer.text;
+}
+
+}// namespace detail
+
+template<size_t... Ns>
+constexpr auto columns(const char (&... names)[Ns])
+{
+    constexpr size_t size = detail::joinedSize<Ns...>(2, detail::Format::Name);
+
+    const std::string_view views[] = { std::string_view(names, Ns - 1)... };
+    return Columns<size, sizeof...(Ns)>{ detail::join<size>(views, ", ", detail::Format::Name) };
+}
+
+template<size_t... Ns>
+constexpr auto where(const char (&... names)[Ns])
+{
+    constexpr size_t size = detail::joinedSize<Ns...>(5, detail::Format::Equals);
+
+    const std::string_view views[] = { std::string_view(names, Ns - 1)... };
+    return Where<size, sizeof...(Ns)>{ detail::join<size>(views, " AND ", detail::Format::Equals) };
+}
+
+// SELECT columns FROM table
+template<size_t T, size_t C, size_t CCount>
+constexpr auto select(const char (&table)[T], const Columns<C, CCount>& selected)
+{
+    return detail::makeQuery<0>(
+        detail::concat(FixedString("SELECT "), selected.text, FixedString(" FROM "), FixedString<T - 1>(table)));
+}
+
+// SELECT columns FROM table WHERE a = ? AND b = ?
+template<size_t T, size_t C, size_t CCount, size_t W, size_t WCount>
+constexpr auto select(const char (&table)[T], const Columns<C, CCount>& selected, const Where<W, WCount>& condition)
+{
+    return detail::makeQuery<WCount>(detail::concat(select(table, selected).text, FixedString(" WHERE "), condition.text));
+}
+
+// INSERT INTO table (columns) VALUES (?, ...)
+template<size_t T, size_t C, size_t CCount>
+constexpr auto insertInto(const char (&table)[T], const Columns<C, CCount>& inserted)
+{
+    return detail::makeQuery<CCount>(detail::concat(
+        FixedString("INSERT INTO "),
+        FixedString<T - 1>(table),
+        FixedString(" ("),
+        inserted.text,
+        FixedString(") VALUES ("),
+        detail::placeholders<CCount>(),
+        FixedString(")")));
+}
+
+// INSERT INTO table (keys, values) VALUES (?, ...) ON CONFLICT (keys) DO UPDATE SET value = excluded.value
+// Parameters are bound keys first, then values.
+template<size_t T, size_t K, size_t KCount, size_t... Ns>
+constexpr auto upsert(const char (&table)[T], const Columns<K, KCount>& keys, const char (&... values)[Ns])
+{
+    constexpr size_t value_size = detail::joinedSize<Ns...>(2, detail::Format::Name);
+    constexpr size_t set_size   = detail::joinedSize<Ns...>(2, detail::Format::Excluded);
+
+    const std::string_view views[] = { std::string_view(values, Ns - 1)... };
+
+    const auto inserted = Columns<K + 2 + value_size, KCount + sizeof...(Ns)>{
+        detail::concat(keys.text, FixedString(", "), detail::join<value_size>(views, ", ", detail::Format::Name))
+    };
+
+    return detail::makeQuery<KCount + sizeof...(Ns)>(detail::concat(
+        insertInto(table, inserted).text,
+        FixedString(" ON CONFLICT ("),
+        keys.text,
+        FixedString(") DO UPDATE SET "),
+        detail::join<set_size>(views, ", ", detail::Format::Excluded)));
+}
+
+// DELETE FROM table WHERE a = ? AND b = ?
+template<size_t T, size_t W, size_t WCount>
+constexpr auto deleteFrom(const char (&table)[T], const Where<W, WCount>& condition)
+{
+    return detail::makeQuery<WCount>(
+        detail::concat(FixedString("DELETE FROM "), FixedString<T - 1>(table), FixedString(" WHERE "), condition.text));
+}
+
+}// namespace sqlitecpp::sql
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct sqlite3;
+struct sqlite3_stmt;
+
+namespace sqlitecpp {
+
+enum class QueryPlanIssue
+{
+    FullScan,      // SCAN of a table without any index
+    TempBTree,     // USE TEMP B-TREE for ORDER BY, GROUP BY or DISTINCT
+    AutomaticIndex,// an index SQLite builds for every execution because none exists
+};
+
+const char* toString(QueryPlanIssue issue);
+
+struct QueryPlanWarning
+{
+    QueryPlanIssue issue;
+    std::string    sql;
+    std::string    detail;// the plan line that raised the warning, e.g. "SCAN users"
+};
+
+using QueryPlanWarningHandler = std::function<void(const QueryPlanWarning&)>;
+
+// One row of EXPLAIN QUERY PLAN, nodes refer to their parent by id (0 is the root)
+struct QueryPlanNode
+{
+    int         id     = 0;
+    int         parent = 0;
+    std::string detail;
+};
+
+struct QueryPlan
+{
+    std::string                sql;
+    std::vector<QueryPlanNode> nodes;
+
+    std::vector<QueryPlanWarning> warnings() const;
+    // Indented tree like the sqlite3 shell's .eqp output
+    std::string toString() const;
+};
+
+// Plans sql without running it, unbound parameters are planned as NULL. Throws if sql does not prepare.
+QueryPlan explainQueryPlan(sqlite3* database, std::string_view sql);
+
+// Measured loops and rows per plan element, as opposed to the planner's estimates
+struct ScanStatus
+{
+    std::string name;   // table or index
+    std::string explain;// the matching EXPLAIN QUERY PLAN line
+    int64_t     loops          = 0;
+    int64_t     rows_visited   = 0;
+    double      estimated_rows = 0;
+};
+
+// Counts accumulated by the statement's executions so far. Empty unless SQLite is compiled with
+// SQLITE_ENABLE_STMT_SCANSTATUS, see the SQLITECPP_ENABLE_STMT_SCANSTATUS CMake option.
+std::vector<ScanStatus> scanStatus(sqlite3_stmt* statement);
+
+}// namespace sqlitecpp
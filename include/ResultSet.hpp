@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "CellValue.hpp"
+#include "ColumnHeader.hpp"
+#include "StatementCache.hpp"
+
+namespace sqlitecpp {
+
+/**
+ * Fully materialized result whose text and blob bytes live in a few contiguous arena blocks. Cells are
+ * fixed-size records pointing into the arena, so reading text hands out std::string_view and destroying the
+ * result frees a handful of blocks instead of one allocation per cell.
+ */
+class ResultSet
+{
+public:
+    class Row
+    {
+    public:
+        template<typename T>
+        T get(size_t index) const
+        {
+            return detail::convertCell<T>(result_set_->cellValue(first_cell_, index));
+        }
+
+        template<typename T>
+        T get(ColumnHandle column) const
+        {
+            return get<T>(column.index);
+        }
+
+        template<typename T>
+        T get(const std::string& column_name) const
+        {
+            return get<T>(result_set_->header().handle(column_name).index);
+        }
+
+        bool isNull(size_t index) const;
+
+    private:
+        friend class ResultSet;
+
+        Row(const ResultSet* result_set, size_t row_index);
+
+        const ResultSet* result_set_;
+        size_t           first_cell_;
+    };
+
+    class Iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = Row;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = void;
+        using reference         = Row;
+
+        Iterator(const ResultSet* result_set, size_t row_index);
+
+        Row       operator*() const;
+        Iterator& operator++();
+        bool      operator==(const Iterator& other) const;
+        bool      operator!=(const Iterator& other) const;
+
+    private:
+        const ResultSet* result_set_;
+        size_t           row_index_;
+    };
+
+    // Steps the statement to completion, copying every cell and its bytes into an arena allocated from upstream
+    ResultSet(CachedStatement statement, std::pmr::memory_resource* upstream);
+
+               ResultSet(ResultSet&& other) noexcept = default;
+    ResultSet& operator=(ResultSet&& other) noexcept = default;
+               ResultSet(const ResultSet&) = delete;
+    ResultSet& operator=(const ResultSet&) = delete;
+
+    size_t              size() const;
+    bool                empty() const;
+    Row                 operator[](size_t row_index) const;
+    Iterator            begin() const;
+    Iterator            end() const;
+    const ColumnHeader& header() const;
+    ColumnHandle        column(const std::string& column_name) const;
+
+private:
+    using CellType = detail::CellType;
+
+    struct Cell
+    {
+        CellType type = CellType::Null;
+        uint32_t size = 0;
+
+        union
+        {
+            int64_t     integer;
+            double      real;
+            const char* bytes;
+        };
+    };
+
+    // Cells and bytes share one arena. Kept together on the heap so moving a result never moves the vector
+    // between arenas, which a polymorphic_allocator would do element by element.
+    struct Storage
+    {
+        explicit Storage(std::pmr::memory_resource* upstream);
+
+        std::pmr::monotonic_buffer_resource arena;
+        std::pmr::vector<Cell>              cells;
+    };
+
+    std::shared_ptr<const ColumnHeader> header_;
+    std::unique_ptr<Storage>            storage_;
+    size_t                              row_count_ = 0;
+
+    const Cell&       cell(size_t first_cell, size_t index) const;
+    detail::CellValue cellValue(size_t first_cell, size_t index) const;
+};
+
+}// namespace sqlitecpp
@@ -0,0 +1,180 @@
+#pragma once
+
+// Coroutine based streaming needs C++20, enable it with -DSQLITECPP_CXX20=ON
+#if __cplusplus >= 202002L && __has_include(<coroutine>)
+
+#include <coroutine>
+#include <exception>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "RowView.hpp"
+#include "SqliteCpp.hpp"
+
+namespace sqlitecpp {
+
+/**
+ * Lazily stepped query result. The statement only advances when the consumer increments the iterator, so
+ * rows can be piped into parsing or network writes without buffering. Yielded rows are borrowed views that
+ * are valid until the next increment. A generator must not outlive its SqliteCpp.
+ */
+class RowGenerator
+{
+public:
+    struct promise_type
+    {
+        const RowView*     current = nullptr;
+        std::exception_ptr error;
+
+        RowGenerator get_return_object()
+        {
+            return RowGenerator(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept
+        {
+            return {};
+        }
+
+        std::suspend_always final_suspend() noexcept
+        {
+            return {};
+        }
+
+        std::suspend_always yield_value(const RowView& row) noexcept
+        {
+            current = &row;
+            return {};
+        }
+
+        void return_void() noexcept
+        {
+        }
+
+        void unhandled_exception() noexcept
+        {
+            error = std::current_exception();
+        }
+    };
+
+    using Handle = std::coroutine_handle<promise_type>;
+
+    class Iterator
+    {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type        = RowView;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = const RowView*;
+        using reference         = const RowView&;
+
+        Iterator() = default;
+
+        explicit Iterator(Handle handle) : handle_(handle)
+        {
+        }
+
+        reference operator*() const
+        {
+            return *handle_.promise().current;
+        }
+
+        pointer operator->() const
+        {
+            return handle_.promise().current;
+        }
+
+        Iterator& operator++()
+        {
+            resume(handle_);
+            return *this;
+        }
+
+        void operator++(int)
+        {
+            ++*this;
+        }
+
+        bool operator==(std::default_sentinel_t) const
+        {
+            return !handle_ || handle_.done();
+        }
+
+    private:
+        Handle handle_;
+    };
+
+                  RowGenerator(RowGenerator&& other) noexcept;
+    RowGenerator& operator=(RowGenerator&&) = delete;
+                  RowGenerator(const RowGenerator&) = delete;
+    RowGenerator& operator=(const RowGenerator&) = delete;
+
+    ~RowGenerator()
+    {
+        if (handle_) {
+            // Destroying the frame releases the statement back to the cache
+            handle_.destroy();
+        }
+    }
+
+    Iterator begin()
+    {
+        resume(handle_);
+        return Iterator(handle_);
+    }
+
+    std::default_sentinel_t end() const noexcept
+    {
+        return {};
+    }
+
+private:
+    explicit RowGenerator(Handle handle) : handle_(handle)
+    {
+    }
+
+    static void resume(Handle handle)
+    {
+        handle.resume();
+        if (auto error = std::exchange(handle.promise().error, nullptr)) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    Handle handle_;
+};
+
+inline RowGenerator::RowGenerator(RowGenerator&& other) noexcept : handle_(std::exchange(other.handle_, nullptr))
+{
+}
+
+// Parameters are taken by value because the coroutine frame outlives the call
+inline RowGenerator streamFromTableWhere(
+    const SqliteCpp&                  database,
+    std::string                       table,
+    std::vector<std::string>          columns       = { "*" },
+    std::map<std::string, SqliteData> where_clauses = {})
+{
+    auto statement = database.statementFromTableWhere(table, columns, where_clauses);
+
+    std::vector<std::string> names;
+    names.reserve(statement.columnCount());
+    for (int i = 0; i < statement.columnCount(); ++i) {
+        names.emplace_back(statement.columnName(i));
+    }
+
+    const ColumnHeader header(std::move(names));
+    const RowView      row(statement, header);
+
+    while (statement.step()) {
+        co_yield row;
+    }
+}
+
+}// namespace sqlitecpp
+
+#endif
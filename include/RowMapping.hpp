@@ -0,0 +1,218 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "CellValue.hpp"
+#include "SqliteData.hpp"
+#include "StatementCache.hpp"
+
+namespace sqlitecpp {
+
+template<typename Struct, typename Member>
+struct Field
+{
+    const char* name;
+    Member Struct::*member;
+};
+
+/**
+ * Maps a struct to a table. Specialize it with SQLITECPP_MAP, which provides
+ *   static constexpr const char* table;
+ *   static constexpr std::tuple<Field<Struct, Member>...> fields;
+ * Columns are bound and extracted in field order, so no names are looked up at runtime.
+ */
+template<typename Struct>
+struct RowMapping;
+
+namespace detail {
+
+template<typename T, typename = void>
+struct IsMapped : std::false_type
+{
+};
+
+template<typename T>
+struct IsMapped<T, std::void_t<decltype(RowMapping<T>::fields)>> : std::true_type
+{
+};
+
+template<typename Fields, typename Function, size_t... Indices>
+void forEachField(const Fields& fields, Function&& function, std::index_sequence<Indices...>)
+{
+    (function(std::get<Indices>(fields), static_cast<int>(Indices)), ...);
+}
+
+template<typename Struct, typename Function>
+void forEachField(Function&& function)
+{
+    constexpr auto& fields = RowMapping<Struct>::fields;
+    forEachField(fields, function, std::make_index_sequence<std::tuple_size_v<std::decay_t<decltype(fields)>>>{});
+}
+
+template<typename T>
+void bindValue(CachedStatement& statement, int index, const T& value, bool copy = false)
+{
+    if constexpr (IsOptional<T>::value) {
+        if (value) {
+            bindValue(statement, index, *value, copy);
+        } else {
+            statement.bindNull(index);
+        }
+    } else if constexpr (std::is_same_v<T, std::nullptr_t>) {
+        statement.bindNull(index);
+    } else if constexpr (std::is_integral_v<T> || std::is_enum_v<T>) {
+        statement.bind(index, static_cast<int64_t>(value));
+    } else if constexpr (std::is_floating_point_v<T>) {
+        statement.bind(index, static_cast<double>(value));
+    } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+        statement.bind(index, std::string_view(value), copy);
+    } else if constexpr (std::is_same_v<T, std::vector<std::byte>>) {
+        statement.bind(index, SqliteBlobView{ value.data(), value.size() }, copy);
+    } else if constexpr (std::is_same_v<T, SqliteBlobView>) {
+        statement.bind(index, value, copy);
+    } else if constexpr (std::is_same_v<T, SqliteZeroBlob>) {
+        statement.bind(index, value);
+    } else {
+        static_assert(ALWAYS_FALSE<T>, "Type cannot be bound to a statement");
+    }
+}
+
+template<typename T>
+void readValue(const CachedStatement& statement, int index, T& value)
+{
+    if constexpr (IsOptional<T>::value) {
+        if (statement.isNull(index)) {
+            value.reset();
+        } else {
+            readValue(statement, index, value.emplace());
+        }
+    } else if (statement.isNull(index)) {
+        // Same as convertCell: NULL only fits an optional member
+        throwNullValue();
+    } else if constexpr (std::is_same_v<T, bool>) {
+        value = statement.columnInt64(index) != 0;
+    } else if constexpr (std::is_integral_v<T> || std::is_enum_v<T>) {
+        value = static_cast<T>(statement.columnInt64(index));
+    } else if constexpr (std::is_floating_point_v<T>) {
+        value = static_cast<T>(statement.columnDouble(index));
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        value = statement.columnText(index);
+    } else if constexpr (std::is_same_v<T, std::vector<std::byte>>) {
+        const auto blob = statement.columnBlob(index);
+        value.assign(blob.data, blob.data + blob.size);
+    } else {
+        static_assert(ALWAYS_FALSE<T>, "Member type cannot be read from a statement");
+    }
+}
+
+template<typename Struct>
+const std::vector<std::string>& columnNames()
+{
+    static const std::vector<std::string> names = [] {
+        std::vector<std::string> result;
+        forEachField<Struct>([&result](const auto& field, int) { result.emplace_back(field.name); });
+        return result;
+    }();
+    return names;
+}
+
+template<typename Struct>
+void bindRow(CachedStatement& statement, const Struct& row, int first_param_index = 1)
+{
+    forEachField<Struct>([&](const auto& field, int index) {
+        bindValue(statement, first_param_index + index, row.*(field.member));
+    });
+}
+
+template<typename Struct>
+void readRow(const CachedStatement& statement, Struct& row)
+{
+    forEachField<Struct>([&](const auto& field, int index) { readValue(statement, index, row.*(field.member)); });
+}
+
+}// namespace detail
+
+}// namespace sqlitecpp
+
+#define SQLITECPP_DETAIL_EXPAND(x) x
+#define SQLITECPP_DETAIL_FIELD(member) ::sqlitecpp::Field<Type, decltype(Type::member)>{ #member, &Type::member }
+
+#define SQLITECPP_DETAIL_FE_1(M, x) M(x)
+#define SQLITECPP_DETAIL_FE_2(M, x, ...) M(x), SQLITECPP_DETAIL_EXPAND(SQLITECPP_DETAIL_FE_1(M, __VA_ARGS__))
+#define SQLITECPP_DETAIL_FE_3(M, x, ...) M(x), SQLITECPP_DETAIL_EXPAND(SQLITECPP_DETAIL_FE_2(M, __VA_ARGS__))
+#define SQLITECPP_DETAIL_FE_4(M, x, ...) M(x), SQLITECPP_DETAIL_EXPAND(SQLITECPP_DETAIL_FE_3(M, __VA_ARGS__))
+#define SQLITECPP_DETAIL_FE_5(M, x, ...) M(x), SQLITECPP_DETAIL_EXPAND(SQLITECPP_DETAIL_FE_4(M, __VA_ARGS__))
+#define SQLITECPP_DETAIL_FE_6(M, x, ...) M(x), SQLITECPP_DETAIL_EXPAND(SQLITECPP_DETAIL_FE_5(M, __VA_ARGS__))
+#define SQLITECPP_DETAIL_FE_7(M, x, ...) M(x), SQLITECPP_DETAIL_EXPAND(SQLITECPP_DETAIL_FE_6(M, __VA_ARGS__))
+#define SQLITECPP_DETAIL_FE_8(M, x, ...) M(x), SQLITECPP_DETAIL_EXPAND(SQLITECPP_DETAIL_FE_7(M, __VA_ARGS__))
+#define SQLITECPP_DETAIL_FE_9(M, x, ...) M(x), SQLITECPP_DETAIL_EXPAND(SQLITECPP_DETAIL_FE_8(M, __VA_ARGS__))
+#define SQLITECPP_DETAIL_FE_10(M, x, ...) M(x), SQLITECPP_DETAIL_EXPAND(SQLITECPP_DETAIL_FE_9(M, __VA_ARGS__))
+#define SQLITECPP_DETAIL_FE_11(M, x, ...) M(x), SQLITECPP_DETAIL_EXPAND(SQLITECPP_DETAIL_FE_10(M, __VA_ARGS__))
+#define SQLITECPP_DETAIL_FE_12(M, x, ...) M(x), SQLITECPP_DETAIL_EXPAND(SQLITECPP_DETAIL_FE_11(M, __VA_ARGS__))
+#define SQLITECPP_DETAIL_FE_13(M, x, ...) M(x), SQLITECPP_DETAIL_EXPAND(SQLITECPP_DETAIL_FE_12(M, __VA_ARGS__))
+#define SQLITECPP_DETAIL_FE_14(M, x, ...) M(x), SQLITECPP_DETAIL_EXPAND(SQLITECPP_DETAIL_FE_13(M, __VA_ARGS__))
+#define SQLITECPP_DETAIL_FE_15(M, x, ...) M(x), SQLITECPP_DETAIL_EXPAND(SQLITECPP_DETAIL_FE_14(M, __VA_ARGS__))
+#define SQLITECPP_DETAIL_FE_16(M, x, ...) M(x), SQLITECPP_DETAIL_EXPAND(SQLITECPP_DETAIL_FE_15(M, __VA_ARGS__))
+#define SQLITECPP_DETAIL_FE_17(M, x, ...) M(x), SQLITECPP_DETAIL_EXPAND(SQLITECPP_DETAIL_FE_16(M, __VA_ARGS__))
+#define SQLITECPP_DETAIL_FE_18(M, x, ...) M(x), SQLITECPP_DETAIL_EXPAND(SQLITECPP_DETAIL_FE_17(M, __VA_ARGS__))
+#define SQLITECPP_DETAIL_FE_19(M, x, ...) M(x), SQLITECPP_DETAIL_EXPAND(SQLITECPP_DETAIL_FE_18(M, __VA_ARGS__))
+#define SQLITECPP_DETAIL_FE_20(M, x, ...) M(x), SQLITECPP_DETAIL_EXPAND(SQLITECPP_DETAIL_FE_19(M, __VA_ARGS__))
+#define SQLITECPP_DETAIL_FE_21(M, x, ...) M(x), SQLITECPP_DETAIL_EXPAND(SQLITECPP_DETAIL_FE_20(M, __VA_ARGS__))
+#define SQLITECPP_DETAIL_FE_22(M, x, ...) M(x), SQLITECPP_DETAIL_EXPAND(SQLITECPP_DETAIL_FE_21(M, __VA_ARGS__))
+#define SQLITECPP_DETAIL_FE_23(M, x, ...) M(x), SQLITECPP_DETAIL_EXPAND(SQLITECPP_DETAIL_FE_22(M, __VA_ARGS__))
+#define SQLITECPP_DETAIL_FE_24(M, x, ...) M(x), SQLITECPP_DETAIL_EXPAND(SQLITECPP_DETAIL_FE_23(M, __VA_ARGS__))
+
+#define SQLITECPP_DETAIL_FE_PICK(                                                                                      \
+    _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, NAME, \
+    ...)                                                                                                               \
+    NAME
+#define SQLITECPP_DETAIL_FOR_EACH(M, ...)                                                                              \
+    SQLITECPP_DETAIL_EXPAND(SQLITECPP_DETAIL_FE_PICK(                                                                  \
+        __VA_ARGS__,                                                                                                   \
+        SQLITECPP_DETAIL_FE_24,                                                                                        \
+        SQLITECPP_DETAIL_FE_23,                                                                                        \
+        SQLITECPP_DETAIL_FE_22,                                                                                        \
+        SQLITECPP_DETAIL_FE_21,                                                                                        \
+        SQLITECPP_DETAIL_FE_20,                                                                                        \
+        SQLITECPP_DETAIL_FE_19,                                                                                        \
+        SQLITECPP_DETAIL_FE_18,                                                                                        \
+        SQLITECPP_DETAIL_FE_17,                                                                                        \
+        SQLITECPP_DETAIL_FE_16,                                                                                        \
+        SQLITECPP_DETAIL_FE_15,                                                                                        \
+        SQLITECPP_DETAIL_FE_14,                                                                                        \
+        SQLITECPP_DETAIL_FE_13,                                                                                        \
+        SQLITECPP_DETAIL_FE_12,                                                                                        \
+        SQLITECPP_DETAIL_FE_11,                                                                                        \
+        SQLITECPP_DETAIL_FE_10,                                                                                        \
+        SQLITECPP_DETAIL_FE_9,                                                                                         \
+        SQLITECPP_DETAIL_FE_8,                                                                                         \
+        SQLITECPP_DETAIL_FE_7,                                                                                         \
+        SQLITECPP_DETAIL_FE_6,                                                                                         \
+        SQLITECPP_DETAIL_FE_5,                                                                                         \
+        SQLITECPP_DETAIL_FE_4,                                                                                         \
+        SQLITECPP_DETAIL_FE_3,                                                                                         \
+        SQLITECPP_DETAIL_FE_2,                                                                                         \
+        SQLITECPP_DETAIL_FE_1)(M, __VA_ARGS__))
+
+/**
+ * Maps Struct to table_name with one column per listed member, named like the member. Use at global scope:
+ *   SQLITECPP_MAP(User, "users", id, name, email)
+ * Supports up to 24 members of integral, enum, floating point, std::string, std::vector<std::byte> or
+ * std::optional of those types.
+ */
+#define SQLITECPP_MAP(Struct, table_name, ...)                                                                         \
+    template<>                                                                                                         \
+    struct sqlitecpp::RowMapping<Struct>                                                                               \
+    {                                                                                                                  \
+        using Type = Struct;                                                                                           \
+                                                                                                                       \
+        static constexpr const char* table  = table_name;                                                              \
+        static constexpr auto        fields = std::make_tuple(SQLITECPP_DETAIL_FOR_EACH(SQLITECPP_DETAIL_FIELD, __VA_ARGS__)); \
+    };
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "CellValue.hpp"
+#include "ColumnHeader.hpp"
+#include "StatementCache.hpp"
+
+namespace sqlitecpp {
+
+/**
+ * Borrowed view of the row a statement is currently positioned on. Nothing is copied: values are read from
+ * SQLite on access and text or blob views point into the statement, so both the view and everything read
+ * through it are only valid until the statement steps again.
+ */
+class RowView
+{
+public:
+    RowView(const CachedStatement& statement, const ColumnHeader& header);
+
+    template<typename T>
+    T get(size_t index) const
+    {
+        return detail::convertCell<T>(cellValue(index));
+    }
+
+    template<typename T>
+    T get(ColumnHandle column) const
+    {
+        return get<T>(column.index);
+    }
+
+    template<typename T>
+    T get(const std::string& column_name) const
+    {
+        return get<T>(header_->handle(column_name).index);
+    }
+
+    bool                isNull(size_t index) const;
+    size_t              size() const;
+    const ColumnHeader& header() const;
+
+private:
+    const CachedStatement* statement_;
+    const ColumnHeader*    header_;
+
+    int               column(size_t index) const;
+    detail::CellValue cellValue(size_t index) const;
+};
+
+}// namespace sqlitecpp
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sqlitecpp {
+
+struct SlowQueryLogOptions
+{
+    std::filesystem::path     path;
+    std::chrono::milliseconds threshold{ 100 };
+    uint64_t                  max_file_bytes = 16 * 1024 * 1024;
+    size_t                    max_files      = 4;// rotated files kept as path.1 (newest) to path.N
+    std::chrono::milliseconds flush_interval{ 1000 };
+    size_t                    max_pending = 10000;// entries waiting for the flusher; further ones are dropped
+};
+
+struct SlowQuery
+{
+    std::chrono::system_clock::time_point finished_at;
+    std::chrono::nanoseconds              duration{ 0 };
+    std::string                           sql;// with bound parameters expanded
+    uint64_t                              rows_returned = 0;
+    uint64_t                              rows_changed  = 0;
+    std::thread::id                       thread;
+    bool                                  waited_on_busy = false;
+};
+
+/**
+ * Statements slower than a threshold, written as JSON lines to a size-rotated file. record() only appends to
+ * an in-memory buffer; a background thread formats and writes the buffer every flush interval, so a slow disk
+ * never stalls the query path. When the buffer is full new entries are dropped and counted instead.
+ */
+class SlowQueryLog
+{
+public:
+    // Opens or creates the log file, throws if it cannot be written
+    explicit SlowQueryLog(SlowQueryLogOptions options);
+
+                  SlowQueryLog(const SlowQueryLog&) = delete;
+    SlowQueryLog& operator=(const SlowQueryLog&) = delete;
+
+    // Writes what is still buffered
+    ~SlowQueryLog();
+
+    std::chrono::nanoseconds threshold() const;
+
+    void record(SlowQuery query);
+    // Blocks until everything recorded so far is written
+    void     flush();
+    uint64_t dropped() const;
+
+private:
+    SlowQueryLogOptions options_;
+
+    mutable std::mutex      mutex_;
+    std::condition_variable wake_;
+    std::condition_variable flushed_;
+    std::vector<SlowQuery>  pending_;
+    uint64_t                dropped_          = 0;
+    uint64_t                flush_requests_   = 0;
+    uint64_t                flushes_finished_ = 0;
+    bool                    stopping_         = false;
+
+    // Only touched by the flusher thread after construction
+    std::ofstream file_;
+    uint64_t      file_bytes_ = 0;
+
+    std::thread flusher_;
+
+    void run();
+    void write(const std::vector<SlowQuery>& queries);
+    void rotate();
+};
+
+}// namespace sqlitecpp
@@ -4,25 +4,37 @@
 #include <functional>
 #include <map>
 #include <memory>
+#include <memory_resource>
+#include <optional>
 #include <string>
+#include <unordered_set>
 #include <utility>
-#include <variant>
 #include <vector>
 
+#include "BlobStream.hpp"
+#include "Cursor.hpp"
+#include "Metrics.hpp"
 #include "Migration.hpp"
+#include "OpenOptions.hpp"
+#include "QueryBuilder.hpp"
+#include "SqliteData.hpp"
+#include "ResultSet.hpp"
+#include "RowMapping.hpp"
 #include "SqliteRow.hpp"
+#include "StatementCache.hpp"
+#include "StatementStats.hpp"
+#include "TraceEvents.hpp"
+#include "Transaction.hpp"
 
 class sqlite3;
 
-using SqliteData = std::variant<std::string, int, std::nullptr_t>;
-
 namespace sqlitecpp {
 
 class SqliteCpp
 {
 public:
-    static SqliteCpp createOrOpenDatabase(const std::filesystem::path& db_path);
-    static SqliteCpp openDatabase(const std::filesystem::path& db_path);
+    static SqliteCpp createOrOpenDatabase(const std::filesystem::path& db_path, const OpenOptions& options = {});
+    static SqliteCpp openDatabase(const std::filesystem::path& db_path, const OpenOptions& options = {});
 
                SqliteCpp(SqliteCpp&& other) noexcept;
     SqliteCpp& operator=(SqliteCpp&& other) noexcept;
@@ -31,7 +43,13 @@ public:
 
     virtual ~SqliteCpp();
 
+    // Runs the migrations not recorded in sqlitecpp_migrations yet, in one transaction. A hash of the titles is
+    // kept in sqlitecpp_meta, so reopening a fully migrated database reads one row instead of the applied set.
+    // Only titles are hashed: like the applied set, it does not notice edits to an applied migration's SQL.
     void runMigrations(const std::vector<Migration>& migrations);
+    // Runs unfinished backfills one after another, each in its own chunk transactions. Must not be called
+    // inside a transaction; run it after runMigrations has added the columns the backfills fill.
+    void runBackfills(const std::vector<BackfillMigration>& backfills);
 
     std::vector<SqliteRow> selectStarFromTable(const std::string& table) const;
     std::vector<SqliteRow> selectFromTableWhere(
@@ -39,21 +57,218 @@ public:
         const std::vector<std::string>&          columns       = { "*" },
         const std::map<std::string, SqliteData>& where_clauses = {}) const;
 
-    void upsert(const std::string& table, const std::map<std::string, SqliteData>& column_to_data);
+    Cursor cursorStarFromTable(const std::string& table) const;
+    Cursor cursorFromTableWhere(
+        const std::string&                       table,
+        const std::vector<std::string>&          columns       = { "*" },
+        const std::map<std::string, SqliteData>& where_clauses = {}) const;
+
+    // Bare statement lease positioned before the first row, e.g. for streamFromTableWhere in RowGenerator.hpp
+    CachedStatement statementFromTableWhere(
+        const std::string&                       table,
+        const std::vector<std::string>&          columns       = { "*" },
+        const std::map<std::string, SqliteData>& where_clauses = {}) const;
+
+    // Copies the whole result into arena blocks taken from resource, e.g. a per-request pool that is reused
+    ResultSet resultSetFromTableWhere(
+        const std::string&                       table,
+        const std::vector<std::string>&          columns       = { "*" },
+        const std::map<std::string, SqliteData>& where_clauses = {},
+        std::pmr::memory_resource*               resource      = std::pmr::get_default_resource()) const;
+
+    // Without conflict columns rows are written with INSERT OR REPLACE, otherwise with ON CONFLICT (...) DO UPDATE
+    void upsert(
+        const std::string&                       table,
+        const std::map<std::string, SqliteData>& column_to_data,
+        const std::vector<std::string>&          conflict_columns = {});
+    void upsertMany(
+        const std::string&                                    table,
+        const std::vector<std::map<std::string, SqliteData>>& rows,
+        const std::vector<std::string>&                       conflict_columns = {});
     void deleteFrom(const std::string& table, const std::map<std::string, SqliteData>& where_clauses);
 
+    // Streams a single blob cell in chunks, see BlobStream
+    BlobStream openBlob(const std::string& table, const std::string& column, int64_t rowid, bool writable = false);
+
+    // Operations are timed into metrics::snapshot() when built with SQLITECPP_ENABLE_METRICS. Cursors, result
+    // streams and blob streams are not, their cost is in the consumer's loop.
+
+    // Struct access for types mapped with SQLITECPP_MAP, binding and reading columns by position
+    template<typename T>
+    void insert(const T& row);
+    template<typename T>
+    std::vector<T> select(const std::map<std::string, SqliteData>& where_clauses = {}) const;
+    template<typename T>
+    void upsertMany(const std::vector<T>& rows, const std::vector<std::string>& conflict_columns = {});
+
+    // Queries built at compile time with the sql:: functions. The argument count is checked against the
+    // query's parameter count; the cursor keeps its own copy of text and blob arguments.
+    template<size_t N, size_t ParameterCount, typename... Args>
+    Cursor query(const sql::Query<N, ParameterCount>& query, const Args&... args) const;
+    template<size_t N, size_t ParameterCount, typename... Args>
+    void execute(const sql::Query<N, ParameterCount>& query, const Args&... args);
+
+    // Must not outlive this connection, nested calls open savepoints inside the current transaction
+    Transaction transaction(TransactionMode mode = TransactionMode::Deferred);
+
+    void                setStatementCacheCapacity(size_t capacity);
+    StatementCacheStats statementCacheStats() const;
+
+    // See OpenOptions::inspect_query_plans to check every query shape the connection prepares
+    QueryPlan explainQueryPlan(const std::string& sql) const;
+
+    // The count fingerprints with the highest total execution time, empty unless opened with statement_stats
+    std::vector<StatementStatsEntry> topStatements(size_t count) const;
+    void                             resetStatementStats();
+
+    // Waits until the slow query log configured in OpenOptions has written everything recorded so far
+    void flushSlowQueryLog();
+
 private:
-    const std::string MIGRATIONS_TABLE = "sqlitecpp_migrations";
-    explicit          SqliteCpp(const std::filesystem::path& db_path);
-    sqlite3*          database_ = nullptr;
+    friend class Transaction;
+    friend class SqliteCppPool;
+
+    struct Tracing;
+
+    const std::string               MIGRATIONS_TABLE = "sqlitecpp_migrations";
+    const std::string               BACKFILLS_TABLE  = "sqlitecpp_backfills";
+    const std::string               META_TABLE       = "sqlitecpp_meta";
+                                    SqliteCpp(const std::filesystem::path& db_path, const OpenOptions& options, bool create);
+    // For SqliteCppPool: every connection of a pool records into the one slow query log it passes here
+                                    SqliteCpp(
+                                        const std::filesystem::path&  db_path,
+                                        const OpenOptions&            options,
+                                        bool                          create,
+                                        std::shared_ptr<SlowQueryLog> slow_query_log);
+    sqlite3*                        database_ = nullptr;
+    std::unique_ptr<StatementCache> statement_cache_;
+    std::unique_ptr<Tracing>        tracing_;
+    size_t                          transaction_depth_ = 0;
+
+    static int onTrace(unsigned event, void* context, void* statement, void* detail);
+    static int onBusy(void* context, int count);
+    static int onWalCommit(void* context, sqlite3* database, const char* schema, int pages);
+
+    // Clears the callbacks into tracing_ and closes with sqlite3_close_v2, which also handles leaked statements
+    void close() noexcept;
+
+    // Id in trace events, 0 unless opened with OpenOptions::trace_events
+    uint64_t traceConnection() const;
 
     bool tableExists(const std::string& tableName) const;
     void createMigrationsTable();
-    void runMigration(const Migration& migration);
+    void createMetaTable();
+    void runMigration(const Migration& migration, CachedStatement& record);
+    void createBackfillsTable();
+    void runBackfill(const BackfillMigration& backfill, metrics::Scope& scope);
+
+    std::unordered_set<std::string> appliedMigrations() const;
+    std::optional<int64_t>          storedMigrationsHash() const;
+    static int64_t                  migrationsHash(const std::vector<Migration>& migrations);
 
-    void beginTransaction();
-    void rollback();
-    void commit();
+    void executeStatement(const std::string& query, const std::string& error_context);
+
+    static std::string upsertQuery(
+        const std::string&              table,
+        const std::vector<std::string>& columns,
+        const std::vector<std::string>& conflict_columns,
+        size_t                          row_count);
+    static std::string insertQuery(const std::string& table, const std::vector<std::string>& columns);
+
+    template<size_t N, size_t ParameterCount, typename... Args>
+    CachedStatement prepareQuery(const sql::Query<N, ParameterCount>& query, bool copy, const Args&... args) const;
+
+    CachedStatement prepareSelect(
+        const std::string&                       table,
+        const std::vector<std::string>&          columns,
+        const std::map<std::string, SqliteData>& where_clauses) const;
+
+    size_t beginTransaction(TransactionMode mode);
+    void   rollback(size_t depth);
+    void   commit(size_t depth);
 };
 
+template<typename T>
+void SqliteCpp::insert(const T& row)
+{
+    static_assert(detail::IsMapped<T>::value, "Map the type with SQLITECPP_MAP first");
+    static const std::string query = insertQuery(RowMapping<T>::table, detail::columnNames<T>());
+
+    metrics::Scope scope(metrics::Operation::Upsert);
+    scope.addRows(1);
+
+    auto statement = statement_cache_->acquire(query);
+    detail::bindRow(statement, row);
+    statement.step();
+}
+
+template<typename T>
+std::vector<T> SqliteCpp::select(const std::map<std::string, SqliteData>& where_clauses) const
+{
+    static_assert(detail::IsMapped<T>::value, "Map the type with SQLITECPP_MAP first");
+
+    metrics::Scope scope(metrics::Operation::Select);
+    auto           statement = prepareSelect(RowMapping<T>::table, detail::columnNames<T>(), where_clauses);
+    std::vector<T> rows;
+
+    while (statement.step()) {
+        detail::readRow(statement, rows.emplace_back());
+    }
+
+    scope.addRows(rows.size());
+    return rows;
+}
+
+template<typename T>
+void SqliteCpp::upsertMany(const std::vector<T>& rows, const std::vector<std::string>& conflict_columns)
+{
+    static_assert(detail::IsMapped<T>::value, "Map the type with SQLITECPP_MAP first");
+
+    if (rows.empty()) {
+        return;
+    }
+
+    metrics::Scope scope(metrics::Operation::Upsert);
+    scope.addRows(rows.size());
+
+    auto batch_transaction = transaction();
+    auto statement = statement_cache_->acquire(upsertQuery(RowMapping<T>::table, detail::columnNames<T>(), conflict_columns, 1));
+
+    for (const auto& row : rows) {
+        detail::bindRow(statement, row);
+        statement.step();
+        statement.reset();
+    }
+
+    statement.release();
+    batch_transaction.commit();
+}
+
+template<size_t N, size_t ParameterCount, typename... Args>
+Cursor SqliteCpp::query(const sql::Query<N, ParameterCount>& query, const Args&... args) const
+{
+    metrics::Scope scope(metrics::Operation::Query);
+    return Cursor(prepareQuery(query, true, args...));
+}
+
+template<size_t N, size_t ParameterCount, typename... Args>
+void SqliteCpp::execute(const sql::Query<N, ParameterCount>& query, const Args&... args)
+{
+    metrics::Scope scope(metrics::Operation::Query);
+    auto           statement = prepareQuery(query, false, args...);
+    while (statement.step()) {
+    }
+}
+
+template<size_t N, size_t ParameterCount, typename... Args>
+CachedStatement SqliteCpp::prepareQuery(const sql::Query<N, ParameterCount>& query, bool copy, const Args&... args) const
+{
+    static_assert(sizeof...(Args) == ParameterCount, "Number of arguments does not match the query's parameters");
+
+    auto statement = statement_cache_->acquire(query.sql());
+    int  index     = 1;
+    (detail::bindValue(statement, index++, args, copy), ...);
+    return statement;
+}
+
 }// namespace sqlitecpp
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "SqliteCpp.hpp"
+
+namespace sqlitecpp {
+
+struct PoolMetrics
+{
+    size_t   reader_count   = 0;
+    size_t   readers_in_use = 0;
+    bool     writer_in_use  = false;
+    uint64_t read_leases    = 0;
+    uint64_t write_leases   = 0;
+
+    std::chrono::nanoseconds total_read_wait{ 0 };
+    std::chrono::nanoseconds max_read_wait{ 0 };
+    std::chrono::nanoseconds total_write_wait{ 0 };
+    std::chrono::nanoseconds max_write_wait{ 0 };
+
+    // Share of the pool's lifetime the connections spent leased out, 0.0 to 1.0
+    double reader_utilization = 0.0;
+    double writer_utilization = 0.0;
+};
+
+/**
+ * N read-only connections plus one writer on the same database file in WAL mode. Reads run in parallel on
+ * the readers, writes queue up for the single writer. Each connection is used by one thread at a time, so
+ * they are opened with SQLITE_OPEN_NOMUTEX. The pool must outlive every lease it hands out.
+ */
+class SqliteCppPool
+{
+public:
+    class Lease
+    {
+    public:
+               Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&&) = delete;
+               Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        ~Lease();
+
+        SqliteCpp& operator*() const;
+        SqliteCpp* operator->() const;
+
+    private:
+        friend class SqliteCppPool;
+
+        Lease(SqliteCppPool* pool, SqliteCpp* connection, bool is_writer);
+
+        SqliteCppPool*                        pool_;
+        SqliteCpp*                            connection_;
+        bool                                  is_writer_;
+        std::chrono::steady_clock::time_point leased_at_;
+    };
+
+    explicit SqliteCppPool(
+        const std::filesystem::path& db_path,
+        size_t                       reader_count = 4,
+        const OpenOptions&           options      = OpenOptions::oltpDurable());
+
+                   SqliteCppPool(const SqliteCppPool&) = delete;
+    SqliteCppPool& operator=(const SqliteCppPool&) = delete;
+
+    Lease read();
+    Lease write();
+
+    PoolMetrics metrics() const;
+
+private:
+    std::unique_ptr<SqliteCpp>              writer_;
+    std::vector<std::unique_ptr<SqliteCpp>> readers_;
+    std::vector<SqliteCpp*>                 idle_readers_;
+    bool                                    writer_in_use_ = false;
+
+    mutable std::mutex                    mutex_;
+    std::condition_variable               reader_released_;
+    std::condition_variable               writer_released_;
+    std::chrono::steady_clock::time_point created_at_;
+    PoolMetrics                           metrics_;
+    std::chrono::nanoseconds              reader_busy_{ 0 };
+    std::chrono::nanoseconds              writer_busy_{ 0 };
+
+    void release(SqliteCpp* connection, bool is_writer, std::chrono::nanoseconds busy);
+};
+
+}// namespace sqlitecpp
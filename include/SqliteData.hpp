@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+namespace sqlitecpp {
+
+// Non-owning text, bound without a copy. The characters must stay alive until the statement has run.
+struct SqliteTextView
+{
+    SqliteTextView(std::string_view text) : text(text)
+    {
+    }
+
+    std::string_view text;
+};
+
+// Non-owning blob, bound without a copy. The bytes must stay alive until the statement has run.
+struct SqliteBlobView
+{
+    const std::byte* data;
+    size_t           size;
+};
+
+// Blob of size zero bytes, allocated without passing any data. Used to reserve space for a BlobStream.
+struct SqliteZeroBlob
+{
+    size_t size;
+};
+
+}// namespace sqlitecpp
+
+using SqliteData = std::variant<
+    std::string,
+    int,
+    std::nullptr_t,
+    int64_t,
+    double,
+    sqlitecpp::SqliteTextView,
+    sqlitecpp::SqliteBlobView,
+    std::vector<std::byte>,
+    sqlitecpp::SqliteZeroBlob>;
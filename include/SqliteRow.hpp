@@ -1,47 +1,60 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <optional>
 #include <string>
-#include <unordered_map>
+#include <variant>
+#include <vector>
+
+#include "CellValue.hpp"
+#include "ColumnHeader.hpp"
 
 namespace sqlitecpp {
 
+// A cell in SQLite's native storage class: NULL, INTEGER, REAL, TEXT or BLOB.
+using SqliteCell = std::variant<std::nullptr_t, int64_t, double, std::string, std::vector<std::byte>>;
+
 class SqliteRow
 {
 public:
+    SqliteRow() = default;
+    explicit SqliteRow(std::shared_ptr<const ColumnHeader> header);
+
+    void set(size_t index, SqliteCell cell_content);
+    // Sets the named column to TEXT or NULL, appending the column if the row does not have it yet. Kept for
+    // rows built by hand; appending copies the header, so rows that share it are not affected.
     void add(const std::string& column_name, const std::optional<std::string>& cell_content);
 
     template<typename T>
-    T get(const std::string& column_name) const
+    T get(size_t index) const
     {
-        throw "todo: not supported";
+        return detail::convertCell<T>(cellValue(index));
     }
 
-    template<>
-    size_t get(const std::string& column_name) const;
-
-    template<>
-    std::optional<size_t> get(const std::string& column_name) const;
-
-    template<>
-    std::optional<double> get(const std::string& column_name) const;
-
-    template<>
-    std::optional<std::string> get(const std::string& column_name) const;
-
-    template<>
-    std::string get(const std::string& column_name) const;
+    template<typename T>
+    T get(ColumnHandle column) const
+    {
+        return get<T>(column.index);
+    }
 
-    template<>
-    bool get(const std::string& column_name) const;
+    template<typename T>
+    T get(const std::string& column_name) const
+    {
+        return get<T>(header().handle(column_name).index);
+    }
 
-    template<>
-    std::optional<int> get(const std::string& column_name) const;
+    const SqliteCell&   cell(size_t index) const;
+    const SqliteCell&   cell(const std::string& column_name) const;
+    const ColumnHeader& header() const;
+    size_t              size() const;
 
 private:
-    std::unordered_map<std::string, std::optional<std::string>> cells_;
+    std::shared_ptr<const ColumnHeader> header_;
+    std::vector<SqliteCell>             cells_;
 
-    void guardColumnExists(const std::string& column_name) const;
+    detail::CellValue cellValue(size_t index) const;
 };
 
-}// namespace finlytics::model
\ No newline at end of file
+}// namespace sqlitecpp
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "QueryPlan.hpp"
+#include "SqliteData.hpp"
+
+struct sqlite3;
+struct sqlite3_stmt;
+
+namespace sqlitecpp {
+
+struct StatementCacheStats
+{
+    size_t hits      = 0;
+    size_t misses    = 0;
+    size_t evictions = 0;
+    size_t size      = 0;
+    size_t capacity  = 0;
+};
+
+class StatementCache;
+
+/**
+ * Lease on a prepared statement. On destruction the statement is reset and its bindings are cleared so the
+ * cache can hand it out again; statements that could not be cached are finalized instead.
+ */
+class CachedStatement
+{
+public:
+    CachedStatement() = default;
+
+                     CachedStatement(CachedStatement&& other) noexcept;
+    CachedStatement& operator=(CachedStatement&& other) noexcept;
+                     CachedStatement(const CachedStatement&) = delete;
+    CachedStatement& operator=(const CachedStatement&) = delete;
+
+    ~CachedStatement();
+
+    sqlite3_stmt* get() const;
+
+    void release();
+
+    // Returns true while a row is available, throws on errors
+    bool step();
+    // Resets the statement and clears its bindings so it can run again
+    void reset();
+
+    // Parameter indices start at 1. Text and blobs are not copied unless copy is set and otherwise have to
+    // outlive the execution.
+    void bind(int index, int64_t value);
+    void bind(int index, double value);
+    void bind(int index, std::string_view value, bool copy = false);
+    void bind(int index, SqliteBlobView value, bool copy = false);
+    void bind(int index, SqliteZeroBlob value);
+    void bindNull(int index);
+
+    // Column indices start at 0. Text and blob views stay valid until the next step or reset.
+    int              columnCount() const;
+    std::string_view columnName(int index) const;
+    bool             isNull(int index) const;
+    int64_t          columnInt64(int index) const;
+    double           columnDouble(int index) const;
+    std::string_view columnText(int index) const;
+    SqliteBlobView   columnBlob(int index) const;
+
+private:
+    friend class StatementCache;
+
+    struct Entry;
+
+    CachedStatement(StatementCache* cache, sqlite3_stmt* statement, Entry* entry);
+
+    StatementCache* cache_     = nullptr;
+    sqlite3_stmt*   statement_ = nullptr;
+    Entry*          entry_     = nullptr;
+};
+
+/**
+ * Per-connection LRU cache of prepared statements keyed by their SQL text, which encodes the query shape
+ * (table, column list and where columns). Cached statements are prepared with SQLITE_PREPARE_PERSISTENT.
+ */
+class StatementCache
+{
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 64;
+
+    explicit StatementCache(sqlite3* database, size_t capacity = DEFAULT_CAPACITY);
+
+                    StatementCache(const StatementCache&) = delete;
+    StatementCache& operator=(const StatementCache&) = delete;
+
+    ~StatementCache();
+
+    CachedStatement acquire(std::string_view sql);
+
+    void                setCapacity(size_t capacity);
+    StatementCacheStats stats() const;
+    void                clear();
+
+    // Explains each query shape the first time it is prepared and passes plan warnings to handler, which may
+    // throw to fail the acquire, e.g. in a test that forbids full scans. An empty handler turns this off.
+    void setPlanInspection(QueryPlanWarningHandler handler);
+    // Records a trace event for every prepare under this connection id, 0 turns it off
+    void setTraceConnection(uint64_t connection);
+
+private:
+    friend class CachedStatement;
+
+    using Entry = CachedStatement::Entry;
+
+    sqlite3*                                                         database_;
+    size_t                                                           capacity_;
+    std::list<Entry>                                                 entries_;// most recently used first
+    std::unordered_map<std::string_view, std::list<Entry>::iterator> index_;
+    size_t                                                           hits_      = 0;
+    size_t                                                           misses_    = 0;
+    size_t                                                           evictions_ = 0;
+    QueryPlanWarningHandler                                          plan_warning_handler_;
+    std::unordered_set<std::string>                                  inspected_shapes_;
+    uint64_t                                                         trace_connection_ = 0;
+
+    sqlite3_stmt* prepare(std::string_view sql, unsigned int flags) const;
+    void          inspectPlan(std::string_view sql);
+    void          release(sqlite3_stmt* statement, Entry* entry);
+    void          evictOverflow();
+};
+
+struct CachedStatement::Entry
+{
+    std::string   sql;
+    sqlite3_stmt* statement = nullptr;
+    bool          in_use    = false;
+};
+
+}// namespace sqlitecpp
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+struct sqlite3_stmt;
+
+namespace sqlitecpp {
+
+// Aggregated executions of one query shape, see SqliteCpp::topStatements
+struct StatementStatsEntry
+{
+    std::string fingerprint;
+
+    uint64_t                 calls = 0;
+    uint64_t                 rows  = 0;
+    std::chrono::nanoseconds total_time{ 0 };
+    std::chrono::nanoseconds max_time{ 0 };
+
+    // sqlite3_stmt_status counters summed over all executions
+    uint64_t full_scan_steps = 0;
+    uint64_t sorts           = 0;
+    uint64_t auto_indexes    = 0;
+    uint64_t vm_steps        = 0;
+
+    std::chrono::nanoseconds meanTime() const;
+};
+
+/**
+ * pg_stat_statements-style aggregation fed by sqlite3_trace_v2. Every finished statement is normalized to a
+ * fingerprint (literals become ?, whitespace and comments are collapsed, repeated VALUES rows fold into one)
+ * and its timing, row count and status counters are added to that fingerprint's entry.
+ * Timings come from SQLITE_TRACE_PROFILE, which most VFSes measure with millisecond resolution.
+ */
+class StatementStats
+{
+public:
+    // Raw SQL texts remembered with their fingerprint, so normalization runs once per distinct text
+    static constexpr size_t MAX_CACHED_TEXTS = 4096;
+
+    static std::string fingerprint(std::string_view sql);
+
+    void onProfile(sqlite3_stmt* statement, int64_t elapsed_ns, uint64_t rows);
+
+    // Entries with the highest total time first
+    std::vector<StatementStatsEntry> top(size_t count) const;
+    void                             reset();
+
+private:
+    mutable std::mutex                                         mutex_;
+    std::unordered_map<std::string, StatementStatsEntry>       entries_;     // by fingerprint
+    std::unordered_map<std::string_view, StatementStatsEntry*> texts_;       // raw SQL to its entry, keys view text_storage_
+    std::deque<std::string>                                    text_storage_;// deque growth never moves the texts
+
+    StatementStatsEntry& entryFor(std::string_view sql);
+};
+
+}// namespace sqlitecpp
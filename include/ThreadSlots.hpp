@@ -0,0 +1,77 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace sqlitecpp::detail {
+
+/**
+ * Per-thread instances of Slot for lock-free recording. Every slot ever handed out stays owned here; slots of
+ * finished threads are reused by new threads with their contents intact, so readers see everything recorded so
+ * far and memory is bounded by the peak number of recording threads.
+ */
+template<typename Slot>
+class ThreadSlots
+{
+public:
+    // The calling thread's slot, acquired on first use and released when the thread exits
+    static Slot& local()
+    {
+        thread_local Lease lease;
+        return *lease.slot;
+    }
+
+    // Calls visit for every slot in creation order, holding the lock that keeps new threads from adding one
+    template<typename Visitor>
+    static void forEach(Visitor&& visit)
+    {
+        auto&                       slots = instance();
+        std::lock_guard<std::mutex> lock(slots.mutex_);
+        for (const auto& slot : slots.slots_) {
+            visit(*slot);
+        }
+    }
+
+private:
+    struct Lease
+    {
+        Slot* slot = instance().acquire();
+
+        ~Lease()
+        {
+            instance().release(slot);
+        }
+    };
+
+    std::mutex                         mutex_;
+    std::vector<std::unique_ptr<Slot>> slots_;
+    std::vector<Slot*>                 idle_;
+
+    static ThreadSlots& instance()
+    {
+        // Never destroyed, threads may still release their slot during static destruction
+        static auto slots = new ThreadSlots();
+        return *slots;
+    }
+
+    Slot* acquire()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if (!idle_.empty()) {
+            auto slot = idle_.back();
+            idle_.pop_back();
+            return slot;
+        }
+        return slots_.emplace_back(std::make_unique<Slot>()).get();
+    }
+
+    void release(Slot* slot)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        idle_.push_back(slot);
+    }
+};
+
+}// namespace sqlitecpp::detail
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+namespace sqlitecpp::trace {
+
+/**
+ * Span recorder for connections opened with OpenOptions::trace_events: prepares, statement executions (first
+ * step to reset), transactions, fsyncs and WAL checkpoints. Each thread writes into its own ring buffer without
+ * locks, overwriting its oldest events when full; exporting reads the rings concurrently through per-slot
+ * sequence numbers. The export is Chrome trace_event JSON, which Perfetto and chrome://tracing load.
+ */
+constexpr size_t RING_CAPACITY = 16384;// events kept per recording thread
+constexpr size_t DETAIL_SIZE   = 88;   // bytes of SQL or file name kept per event
+
+// Nanoseconds on the steady clock since the library was loaded
+int64_t now();
+
+uint64_t nextConnectionId();
+
+// Connection that VFS level events on this thread are attributed to
+void     setCurrentConnection(uint64_t connection);
+uint64_t currentConnection();
+
+void record(const char* name, const char* category, int64_t start_ns, int64_t end_ns, uint64_t connection, std::string_view detail = {});
+
+// Name of a VFS that forwards to the default one and records xSync calls, registered on first use
+const char* vfsName();
+
+std::string toChromeJson();
+void        writeChromeTrace(const std::filesystem::path& path);
+// Drops the events recorded so far
+void clear();
+
+}// namespace sqlitecpp::trace
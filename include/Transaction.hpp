@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Metrics.hpp"
+
+namespace sqlitecpp {
+
+class SqliteCpp;
+
+enum class TransactionMode
+{
+    Deferred,
+    Immediate,
+    Exclusive,
+};
+
+/**
+ * Scope guard for a transaction. The outermost guard issues BEGIN/COMMIT, nested guards map to
+ * SAVEPOINT/RELEASE. A guard that is neither committed nor rolled back rolls back on destruction.
+ */
+class Transaction
+{
+public:
+                 Transaction(Transaction&& other) noexcept;
+    Transaction& operator=(Transaction&&) = delete;
+                 Transaction(const Transaction&) = delete;
+    Transaction& operator=(const Transaction&) = delete;
+
+    ~Transaction();
+
+    void commit();
+    void rollback();
+
+    bool isActive() const;
+    bool isNested() const;
+
+private:
+    friend class SqliteCpp;
+
+    Transaction(SqliteCpp& database, TransactionMode mode);
+
+    SqliteCpp*         database_;
+    size_t             depth_;
+    metrics::Stopwatch stopwatch_;
+    int64_t            trace_started_ns_ = 0;// set when the connection records trace events
+
+    void guardInnermost() const;
+};
+
+}// namespace sqlitecpp
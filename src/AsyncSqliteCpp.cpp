@@ -0,0 +1,217 @@
+#include "AsyncSqliteCpp.hpp"
+
+#include <algorithm>
+
+namespace sqlitecpp {
+
+struct AsyncSqliteCpp::Node
+{
+    std::atomic<Node*>    next{ nullptr };
+    std::unique_ptr<Task> task;
+};
+
+namespace {
+
+OpenOptions workerOptions(OpenOptions options)
+{
+    // Only the worker thread touches the connection
+    options.no_mutex = true;
+    return options;
+}
+
+}// namespace
+
+AsyncSqliteCpp::AsyncSqliteCpp(const std::filesystem::path& db_path, const OpenOptions& options, size_t max_batch)
+    : database_(SqliteCpp::createOrOpenDatabase(db_path, workerOptions(options))),
+      max_batch_(max_batch > 0 ? max_batch : 1),
+      head_(new Node()),
+      tail_(head_.load())
+{
+    worker_ = std::thread([this] { run(); });
+}
+
+AsyncSqliteCpp::~AsyncSqliteCpp()
+{
+    stopping_.store(true);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        wake_.notify_one();
+    }
+    worker_.join();
+
+    while (tail_ != nullptr) {
+        auto next = tail_->next.load();
+        delete tail_;
+        tail_ = next;
+    }
+}
+
+std::future<std::vector<SqliteRow>> AsyncSqliteCpp::selectFromTableWhere(
+    std::string                       table,
+    std::vector<std::string>          columns,
+    std::map<std::string, SqliteData> where_clauses)
+{
+    return submit(
+        false,
+        [table = std::move(table), columns = std::move(columns), where_clauses = std::move(where_clauses)](SqliteCpp& database) {
+            return database.selectFromTableWhere(table, columns, where_clauses);
+        });
+}
+
+std::future<void> AsyncSqliteCpp::upsert(
+    std::string                       table,
+    std::map<std::string, SqliteData> column_to_data,
+    std::vector<std::string>          conflict_columns)
+{
+    return submit(
+        true,
+        [table = std::move(table), column_to_data = std::move(column_to_data), conflict_columns = std::move(conflict_columns)](
+            SqliteCpp& database) { database.upsert(table, column_to_data, conflict_columns); });
+}
+
+std::future<void> AsyncSqliteCpp::deleteFrom(std::string table, std::map<std::string, SqliteData> where_clauses)
+{
+    return submit(true, [table = std::move(table), where_clauses = std::move(where_clauses)](SqliteCpp& database) {
+        database.deleteFrom(table, where_clauses);
+    });
+}
+
+void AsyncSqliteCpp::push(std::unique_ptr<Task> task)
+{
+    auto node  = new Node();
+    node->task = std::move(task);
+
+    // Between the exchange and the link the node is invisible to the worker, which then simply sees an empty
+    // queue; the producer wakes it up after linking.
+    auto previous = head_.exchange(node);
+    previous->next.store(node);
+
+    if (sleeping_.load()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        wake_.notify_one();
+    }
+}
+
+std::unique_ptr<AsyncSqliteCpp::Task> AsyncSqliteCpp::pop()
+{
+    auto next = tail_->next.load(std::memory_order_acquire);
+    if (next == nullptr) {
+        return nullptr;
+    }
+
+    delete tail_;
+    tail_ = next;
+    return std::move(next->task);
+}
+
+bool AsyncSqliteCpp::isEmpty() const
+{
+    return tail_->next.load() == nullptr;
+}
+
+void AsyncSqliteCpp::run()
+{
+    std::vector<std::unique_ptr<Task>> batch;
+    batch.reserve(max_batch_);
+
+    while (true) {
+        while (batch.size() < max_batch_) {
+            auto task = pop();
+            if (!task) {
+                break;
+            }
+            batch.push_back(std::move(task));
+        }
+
+        if (!batch.empty()) {
+            execute(batch);
+            batch.clear();
+            continue;
+        }
+
+        if (stopping_.load()) {
+            // Requests pushed right before the stop flag are visible now
+            if (isEmpty()) {
+                return;
+            }
+            continue;
+        }
+
+        waitForWork();
+    }
+}
+
+void AsyncSqliteCpp::waitForWork()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    // Paired with push: either the producer sees the flag and notifies, or the predicate sees the new node
+    sleeping_.store(true);
+    wake_.wait(lock, [this] { return !isEmpty() || stopping_.load(); });
+    sleeping_.store(false);
+}
+
+void AsyncSqliteCpp::execute(std::vector<std::unique_ptr<Task>>& batch)
+{
+    auto it = batch.begin();
+
+    while (it != batch.end()) {
+        if ((*it)->is_write) {
+            auto last = std::find_if(it, batch.end(), [](const auto& task) { return !task->is_write; });
+            executeWrites(it, last);
+            it = last;
+            continue;
+        }
+
+        auto& task = **it;
+        try {
+            task.run(database_);
+            task.complete();
+        } catch (...) {
+            task.fail(std::current_exception());
+        }
+        ++it;
+    }
+}
+
+void AsyncSqliteCpp::executeWrites(
+    std::vector<std::unique_ptr<Task>>::iterator first,
+    std::vector<std::unique_ptr<Task>>::iterator last)
+{
+    std::vector<Task*> succeeded;
+    auto               next = first;
+
+    try {
+        auto batch_transaction = database_.transaction(TransactionMode::Immediate);
+
+        for (; next != last; ++next) {
+            auto& task = **next;
+            try {
+                auto savepoint = database_.transaction();
+                task.run(database_);
+                savepoint.commit();
+                succeeded.push_back(&task);
+            } catch (...) {
+                task.fail(std::current_exception());
+            }
+        }
+
+        batch_transaction.commit();
+    } catch (...) {
+        // BEGIN or COMMIT failed, nothing of this batch is durable
+        const auto error = std::current_exception();
+        for (auto task : succeeded) {
+            task->fail(error);
+        }
+        for (; next != last; ++next) {
+            (*next)->fail(error);
+        }
+        return;
+    }
+
+    for (auto task : succeeded) {
+        task->complete();
+    }
+}
+
+}// namespace sqlitecpp
@@ -0,0 +1,141 @@
+#include "BlobStream.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <string>
+
+#include "../sqlite/sqlite3.h"
+
+#include "SqliteException.hpp"
+
+namespace sqlitecpp {
+
+BlobStream::BlobStream(sqlite3_blob* blob, bool writable)
+    : blob_(blob), writable_(writable), size_(static_cast<size_t>(sqlite3_blob_bytes(blob)))
+{
+}
+
+BlobStream::BlobStream(BlobStream&& other) noexcept
+    : blob_(other.blob_), writable_(other.writable_), size_(other.size_), position_(other.position_)
+{
+    other.blob_ = nullptr;
+}
+
+BlobStream& BlobStream::operator=(BlobStream&& other) noexcept
+{
+    if (this != &other) {
+        close();
+        blob_       = other.blob_;
+        writable_   = other.writable_;
+        size_       = other.size_;
+        position_   = other.position_;
+        other.blob_ = nullptr;
+    }
+    return *this;
+}
+
+BlobStream::~BlobStream()
+{
+    close();
+}
+
+size_t BlobStream::size() const
+{
+    return size_;
+}
+
+bool BlobStream::isWritable() const
+{
+    return writable_;
+}
+
+size_t BlobStream::read(std::byte* buffer, size_t count)
+{
+    count = std::min(count, size_ - position_);
+    if (count == 0) {
+        return 0;
+    }
+
+    readAt(position_, buffer, count);
+    position_ += count;
+    return count;
+}
+
+void BlobStream::write(const std::byte* data, size_t count)
+{
+    writeAt(position_, data, count);
+    position_ += count;
+}
+
+size_t BlobStream::tell() const
+{
+    return position_;
+}
+
+void BlobStream::seek(size_t position)
+{
+    if (position > size_) {
+        throw exception::SqliteException("Blob position out of range");
+    }
+    position_ = position;
+}
+
+void BlobStream::readAt(size_t offset, std::byte* buffer, size_t count) const
+{
+    guardRange(offset, count);
+
+    if (sqlite3_blob_read(blob_, buffer, static_cast<int>(count), static_cast<int>(offset)) != SQLITE_OK) {
+        throw exception::SqliteException("Failed to read blob, the row may have been modified");
+    }
+}
+
+void BlobStream::writeAt(size_t offset, const std::byte* data, size_t count)
+{
+    if (!writable_) {
+        throw exception::SqliteException("Blob stream is read only");
+    }
+    guardRange(offset, count);
+
+    if (sqlite3_blob_write(blob_, data, static_cast<int>(count), static_cast<int>(offset)) != SQLITE_OK) {
+        throw exception::SqliteException("Failed to write blob, the row may have been modified");
+    }
+}
+
+void BlobStream::reopen(int64_t rowid)
+{
+    if (blob_ == nullptr) {
+        throw exception::SqliteException("Blob stream is closed");
+    }
+
+    if (sqlite3_blob_reopen(blob_, rowid) != SQLITE_OK) {
+        // SQLite leaves the handle aborted, only closing it is still allowed
+        close();
+        throw exception::SqliteException("Failed to reopen blob at rowid " + std::to_string(rowid));
+    }
+
+    size_     = static_cast<size_t>(sqlite3_blob_bytes(blob_));
+    position_ = 0;
+}
+
+void BlobStream::close()
+{
+    if (blob_ != nullptr) {
+        sqlite3_blob_close(blob_);
+    }
+    blob_     = nullptr;
+    size_     = 0;
+    position_ = 0;
+}
+
+void BlobStream::guardRange(size_t offset, size_t count) const
+{
+    if (blob_ == nullptr) {
+        throw exception::SqliteException("Blob stream is closed");
+    }
+
+    if (offset > size_ || count > size_ - offset || count > INT_MAX) {
+        throw exception::SqliteException("Blob range out of bounds");
+    }
+}
+
+}// namespace sqlitecpp
@@ -0,0 +1,86 @@
+#include "CellValue.hpp"
+
+#include "../sqlite/sqlite3.h"
+
+#include "SqliteException.hpp"
+
+namespace sqlitecpp::detail {
+
+void throwNullValue()
+{
+    throw exception::SqliteException("Requested value is null");
+}
+
+int64_t toInteger(const CellValue& cell)
+{
+    switch (cell.type) {
+        case CellType::Integer:
+            return cell.integer;
+        case CellType::Real:
+            return static_cast<int64_t>(cell.real);
+        case CellType::Text:
+            // Only TEXT-affinity columns holding digits end up here
+            return std::stoll(std::string(cell.bytes));
+        default:
+            throw exception::SqliteException("Requested value is not numeric");
+    }
+}
+
+double toDouble(const CellValue& cell)
+{
+    switch (cell.type) {
+        case CellType::Integer:
+            return static_cast<double>(cell.integer);
+        case CellType::Real:
+            return cell.real;
+        case CellType::Text:
+            return std::stod(std::string(cell.bytes));
+        default:
+            throw exception::SqliteException("Requested value is not numeric");
+    }
+}
+
+bool toBool(const CellValue& cell)
+{
+    if (cell.type == CellType::Text) {
+        return cell.bytes == "1";
+    }
+    return toInteger(cell) != 0;
+}
+
+std::string toText(const CellValue& cell)
+{
+    switch (cell.type) {
+        case CellType::Integer:
+            return std::to_string(cell.integer);
+        case CellType::Real: {
+            // Same formatting SQLite applies when a REAL is read as TEXT
+            char*       formatted = sqlite3_mprintf("%!.15g", cell.real);
+            std::string text(formatted);
+            sqlite3_free(formatted);
+            return text;
+        }
+        case CellType::Null:
+            throwNullValue();
+        default:
+            return std::string(cell.bytes);
+    }
+}
+
+std::string_view toBytes(const CellValue& cell)
+{
+    if (cell.type != CellType::Text && cell.type != CellType::Blob) {
+        throw exception::SqliteException("Requested value is not text");
+    }
+    return cell.bytes;
+}
+
+std::vector<std::byte> toByteVector(const CellValue& cell)
+{
+    const auto text  = cell.type == CellType::Text || cell.type == CellType::Blob ? std::string() : toText(cell);
+    const auto bytes = text.empty() ? cell.bytes : std::string_view(text);
+    const auto data  = reinterpret_cast<const std::byte*>(bytes.data());
+    return std::vector<std::byte>(data, data + bytes.size());
+}
+
+}// namespace sqlitecpp::detail
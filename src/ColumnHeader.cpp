@@ -0,0 +1,44 @@
+#include "ColumnHeader.hpp"
+
+#include "SqliteException.hpp"
+
+namespace sqlitecpp {
+
+ColumnHeader::ColumnHeader(std::vector<std::string> names) : names_(std::move(names))
+{
+    indices_.reserve(names_.size());
+
+    // Like sqlite3_exec, a duplicated column name resolves to the last column carrying it
+    for (size_t i = 0; i < names_.size(); ++i) {
+        indices_[names_[i]] = i;
+    }
+}
+
+size_t ColumnHeader::size() const
+{
+    return names_.size();
+}
+
+const std::string& ColumnHeader::name(size_t index) const
+{
+    if (index >= names_.size()) {
+        throw exception::SqliteException("Column not found");
+    }
+    return names_[index];
+}
+
+ColumnHandle ColumnHeader::handle(const std::string& column_name) const
+{
+    auto found = indices_.find(column_name);
+    if (found == indices_.end()) {
+        throw exception::SqliteException("Column not found");
+    }
+    return ColumnHandle{ found->second };
+}
+
+bool ColumnHeader::contains(const std::string& column_name) const
+{
+    return indices_.find(column_name) != indices_.end();
+}
+
+}// namespace sqlitecpp
@@ -0,0 +1,154 @@
+#include "Cursor.hpp"
+
+#include "../sqlite/sqlite3.h"
+
+#include "SqliteException.hpp"
+
+namespace sqlitecpp {
+
+namespace {
+
+std::shared_ptr<const ColumnHeader> readHeader(sqlite3_stmt* statement)
+{
+    std::vector<std::string> names;
+    names.reserve(sqlite3_column_count(statement));
+
+    for (int i = 0; i < sqlite3_column_count(statement); ++i) {
+        names.emplace_back(sqlite3_column_name(statement, i));
+    }
+
+    return std::make_shared<const ColumnHeader>(std::move(names));
+}
+
+void readRow(sqlite3_stmt* statement, SqliteRow& row)
+{
+    // Keep every cell in its native storage class so no number is formatted as text and parsed back
+    for (int i = 0; i < static_cast<int>(row.size()); ++i) {
+        switch (sqlite3_column_type(statement, i)) {
+            case SQLITE_INTEGER:
+                row.set(i, static_cast<int64_t>(sqlite3_column_int64(statement, i)));
+                break;
+            case SQLITE_FLOAT:
+                row.set(i, sqlite3_column_double(statement, i));
+                break;
+            case SQLITE_TEXT:
+                row.set(
+                    i,
+                    std::string(
+                        reinterpret_cast<const char*>(sqlite3_column_text(statement, i)),
+                        sqlite3_column_bytes(statement, i)));
+                break;
+            case SQLITE_BLOB: {
+                const auto data = static_cast<const std::byte*>(sqlite3_column_blob(statement, i));
+                row.set(i, std::vector<std::byte>(data, data + sqlite3_column_bytes(statement, i)));
+                break;
+            }
+            default:
+                row.set(i, nullptr);
+                break;
+        }
+    }
+}
+
+}// namespace
+
+Cursor::Iterator::Iterator(Cursor* cursor) : cursor_(cursor)
+{
+}
+
+Cursor::Iterator::reference Cursor::Iterator::operator*() const
+{
+    return cursor_->row();
+}
+
+Cursor::Iterator::pointer Cursor::Iterator::operator->() const
+{
+    return &cursor_->row();
+}
+
+Cursor::Iterator& Cursor::Iterator::operator++()
+{
+    cursor_->next();
+    return *this;
+}
+
+bool Cursor::Iterator::operator==(const Iterator& other) const
+{
+    return atEnd() == other.atEnd();
+}
+
+bool Cursor::Iterator::operator!=(const Iterator& other) const
+{
+    return !(*this == other);
+}
+
+bool Cursor::Iterator::atEnd() const
+{
+    return cursor_ == nullptr || cursor_->done_;
+}
+
+Cursor::Cursor(CachedStatement statement)
+    : statement_(std::move(statement)), header_(readHeader(statement_.get())), row_(header_)
+{
+}
+
+Cursor::Iterator Cursor::begin()
+{
+    if (!started_) {
+        next();
+    }
+    return Iterator(this);
+}
+
+Cursor::Iterator Cursor::end()
+{
+    return Iterator();
+}
+
+bool Cursor::next()
+{
+    if (done_) {
+        return false;
+    }
+    started_ = true;
+
+    int result = sqlite3_step(statement_.get());
+
+    if (result == SQLITE_ROW) {
+        readRow(statement_.get(), row_);
+        return true;
+    }
+
+    done_ = true;
+
+    if (result != SQLITE_DONE) {
+        std::string exception_message = "Error querying database: ";
+        exception_message += sqlite3_errmsg(sqlite3_db_handle(statement_.get()));
+        statement_.release();
+        throw exception::SqliteException(exception_message);
+    }
+
+    // Hand the statement back to the cache as soon as the result is exhausted
+    statement_.release();
+    return false;
+}
+
+const ColumnHeader& Cursor::header() const
+{
+    return *header_;
+}
+
+ColumnHandle Cursor::column(const std::string& column_name) const
+{
+    return header_->handle(column_name);
+}
+
+const SqliteRow& Cursor::row() const
+{
+    if (!started_ || done_) {
+        throw exception::SqliteException("Cursor is not positioned on a row");
+    }
+    return row_;
+}
+
+}// namespace sqlitecpp
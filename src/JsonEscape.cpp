@@ -0,0 +1,38 @@
+#include "JsonEscape.hpp"
+
+namespace sqlitecpp::detail {
+
+void appendJsonEscaped(std::string& out, std::string_view text)
+{
+    static constexpr char HEX[] = "0123456789abcdef";
+
+    for (const char c : text) {
+        switch (c) {
+            case '"':
+                out += "\\\"";
+                break;
+            case '\\':
+                out += "\\\\";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            case '\r':
+                out += "\\r";
+                break;
+            case '\t':
+                out += "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    out += "\\u00";
+                    out += HEX[(c >> 4) & 0xf];
+                    out += HEX[c & 0xf];
+                } else {
+                    out += c;
+                }
+        }
+    }
+}
+
+}// namespace sqlitecpp::detail
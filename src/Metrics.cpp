@@ -0,0 +1,279 @@
+#include "Metrics.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include "SqliteException.hpp"
+#include "ThreadSlots.hpp"
+
+namespace sqlitecpp::metrics {
+
+namespace {
+
+// Only the owning thread writes a shard, so a relaxed load and store is enough and avoids a locked RMW
+void add(std::atomic<uint64_t>& counter, uint64_t value)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+int highestBit(uint64_t value)
+{
+    int bit = 0;
+    while (value >>= 1) {
+        ++bit;
+    }
+    return bit;
+}
+
+}// namespace
+
+struct Shard
+{
+    struct Counters
+    {
+        std::atomic<uint64_t> calls{ 0 };
+        std::atomic<uint64_t> errors{ 0 };
+        std::atomic<uint64_t> rows{ 0 };
+        std::atomic<uint64_t> bytes{ 0 };
+        std::atomic<uint64_t> count{ 0 };
+        std::atomic<uint64_t> sum_ns{ 0 };
+        std::atomic<uint64_t> max_ns{ 0 };
+
+        std::array<std::atomic<uint64_t>, LatencyHistogram::BUCKET_COUNT> buckets{};
+    };
+
+    std::array<Counters, OPERATION_COUNT> operations;
+
+    void record(Operation operation, uint64_t latency_ns, bool failed, uint64_t rows, uint64_t bytes)
+    {
+        auto& counters = operations[static_cast<size_t>(operation)];
+
+        add(counters.calls, 1);
+        add(counters.errors, failed ? 1 : 0);
+        add(counters.rows, rows);
+        add(counters.bytes, bytes);
+        add(counters.count, 1);
+        add(counters.sum_ns, latency_ns);
+        add(counters.buckets[LatencyHistogram::bucketIndex(latency_ns)], 1);
+
+        if (latency_ns > counters.max_ns.load(std::memory_order_relaxed)) {
+            counters.max_ns.store(latency_ns, std::memory_order_relaxed);
+        }
+    }
+
+    void mergeInto(Snapshot& snapshot) const
+    {
+        for (size_t i = 0; i < OPERATION_COUNT; ++i) {
+            const auto& counters = operations[i];
+            auto&       stats    = snapshot.operations[i];
+
+            stats.calls += counters.calls.load(std::memory_order_relaxed);
+            stats.errors += counters.errors.load(std::memory_order_relaxed);
+            stats.rows += counters.rows.load(std::memory_order_relaxed);
+            stats.bytes += counters.bytes.load(std::memory_order_relaxed);
+
+            auto& histogram = stats.latency;
+            histogram.count_ += counters.count.load(std::memory_order_relaxed);
+            histogram.sum_ns_ += counters.sum_ns.load(std::memory_order_relaxed);
+            histogram.max_ns_ = std::max(histogram.max_ns_, counters.max_ns.load(std::memory_order_relaxed));
+            for (size_t bucket = 0; bucket < LatencyHistogram::BUCKET_COUNT; ++bucket) {
+                histogram.buckets_[bucket] += counters.buckets[bucket].load(std::memory_order_relaxed);
+            }
+        }
+    }
+};
+
+namespace {
+
+void writeCounter(std::ostringstream& out, const char* name, const char* help, const Snapshot& snapshot, uint64_t OperationStats::*member)
+{
+    out << "# HELP " << name << " " << help << "\n# TYPE " << name << " counter\n";
+    for (size_t i = 0; i < OPERATION_COUNT; ++i) {
+        out << name << "{operation=\"" << toString(static_cast<Operation>(i)) << "\"} " << snapshot.operations[i].*member << "\n";
+    }
+}
+
+}// namespace
+
+const char* toString(Operation operation)
+{
+    switch (operation) {
+        case Operation::Select:
+            return "select";
+        case Operation::Upsert:
+            return "upsert";
+        case Operation::Delete:
+            return "delete";
+        case Operation::Migration:
+            return "migration";
+        case Operation::Transaction:
+            return "transaction";
+        case Operation::Query:
+            return "query";
+    }
+    return "unknown";
+}
+
+size_t LatencyHistogram::bucketIndex(uint64_t nanoseconds)
+{
+    if (nanoseconds < SUB_BUCKETS) {
+        return static_cast<size_t>(nanoseconds);
+    }
+
+    const auto exponent = static_cast<size_t>(highestBit(nanoseconds));
+    if (exponent >= MAX_EXPONENT) {
+        return BUCKET_COUNT - 1;
+    }
+
+    const auto shift = exponent - SUB_BUCKET_BITS;
+    return (shift + 1) * SUB_BUCKETS + static_cast<size_t>((nanoseconds >> shift) - SUB_BUCKETS);
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t index)
+{
+    if (index < SUB_BUCKETS) {
+        return index;
+    }
+
+    const auto shift = index / SUB_BUCKETS - 1;
+    const auto lower = static_cast<uint64_t>(SUB_BUCKETS + index % SUB_BUCKETS) << shift;
+    return lower + (uint64_t(1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t nanoseconds)
+{
+    ++buckets_[bucketIndex(nanoseconds)];
+    ++count_;
+    sum_ns_ += nanoseconds;
+    max_ns_ = std::max(max_ns_, nanoseconds);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other)
+{
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        buckets_[i] += other.buckets_[i];
+    }
+    count_ += other.count_;
+    sum_ns_ += other.sum_ns_;
+    max_ns_ = std::max(max_ns_, other.max_ns_);
+}
+
+uint64_t LatencyHistogram::count() const
+{
+    return count_;
+}
+
+std::chrono::nanoseconds LatencyHistogram::sum() const
+{
+    return std::chrono::nanoseconds(sum_ns_);
+}
+
+std::chrono::nanoseconds LatencyHistogram::max() const
+{
+    return std::chrono::nanoseconds(max_ns_);
+}
+
+std::chrono::nanoseconds LatencyHistogram::percentile(double quantile) const
+{
+    if (count_ == 0) {
+        return std::chrono::nanoseconds(0);
+    }
+
+    const auto rank = static_cast<uint64_t>(quantile * static_cast<double>(count_ - 1)) + 1;
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        seen += buckets_[i];
+        if (seen >= rank) {
+            return std::chrono::nanoseconds(std::min(bucketUpperBound(i), max_ns_));
+        }
+    }
+    return std::chrono::nanoseconds(max_ns_);
+}
+
+const std::array<uint64_t, LatencyHistogram::BUCKET_COUNT>& LatencyHistogram::buckets() const
+{
+    return buckets_;
+}
+
+const OperationStats& Snapshot::operator[](Operation operation) const
+{
+    return operations[static_cast<size_t>(operation)];
+}
+
+Snapshot snapshot()
+{
+    Snapshot result;
+
+    detail::ThreadSlots<Shard>::forEach([&result](const Shard& shard) { shard.mergeInto(result); });
+
+    return result;
+}
+
+void record(Operation operation, std::chrono::nanoseconds latency, bool failed, uint64_t rows, uint64_t bytes)
+{
+    detail::ThreadSlots<Shard>::local().record(operation, static_cast<uint64_t>(latency.count()), failed, rows, bytes);
+}
+
+std::string toPrometheus(const Snapshot& snapshot)
+{
+    // Coarse decimal bounds for dashboards, each resolved to the histogram's bucket resolution
+    static constexpr std::array<uint64_t, 10> BOUNDS_NS = {
+        1'000, 10'000, 100'000, 500'000, 1'000'000, 5'000'000, 10'000'000, 100'000'000, 1'000'000'000, 10'000'000'000,
+    };
+
+    std::ostringstream out;
+
+    writeCounter(out, "sqlitecpp_operations_total", "Calls of SqliteCpp operations", snapshot, &OperationStats::calls);
+    writeCounter(out, "sqlitecpp_operation_errors_total", "Failed calls and rolled back transactions", snapshot, &OperationStats::errors);
+    writeCounter(out, "sqlitecpp_rows_total", "Rows read or written", snapshot, &OperationStats::rows);
+    writeCounter(out, "sqlitecpp_bytes_total", "Text and blob bytes read or written", snapshot, &OperationStats::bytes);
+
+    out << "# HELP sqlitecpp_operation_duration_seconds Latency of SqliteCpp operations\n";
+    out << "# TYPE sqlitecpp_operation_duration_seconds histogram\n";
+
+    for (size_t i = 0; i < OPERATION_COUNT; ++i) {
+        const auto& histogram = snapshot.operations[i].latency;
+        const auto  label     = std::string("operation=\"") + toString(static_cast<Operation>(i)) + "\"";
+
+        uint64_t cumulative = 0;
+        size_t   bucket     = 0;
+        for (const auto bound : BOUNDS_NS) {
+            while (bucket < LatencyHistogram::BUCKET_COUNT && LatencyHistogram::bucketUpperBound(bucket) <= bound) {
+                cumulative += histogram.buckets()[bucket++];
+            }
+
+            char le[32];
+            std::snprintf(le, sizeof(le), "%g", static_cast<double>(bound) / 1e9);
+            out << "sqlitecpp_operation_duration_seconds_bucket{" << label << ",le=\"" << le << "\"} " << cumulative << "\n";
+        }
+
+        out << "sqlitecpp_operation_duration_seconds_bucket{" << label << ",le=\"+Inf\"} " << histogram.count() << "\n";
+        out << "sqlitecpp_operation_duration_seconds_sum{" << label << "} "
+            << std::chrono::duration<double>(histogram.sum()).count() << "\n";
+        out << "sqlitecpp_operation_duration_seconds_count{" << label << "} " << histogram.count() << "\n";
+    }
+
+    return out.str();
+}
+
+void writePrometheus(const Snapshot& snapshot, const std::filesystem::path& path)
+{
+    auto temporary_path = path;
+    temporary_path += ".tmp";
+
+    {
+        std::ofstream file(temporary_path, std::ios::trunc);
+        file << toPrometheus(snapshot);
+        if (!file) {
+            throw exception::SqliteException("Failed to write metrics to " + temporary_path.string());
+        }
+    }
+
+    std::filesystem::rename(temporary_path, path);
+}
+
+}// namespace sqlitecpp::metrics
@@ -18,4 +18,29 @@ const std::string& Migration::getMigration() const
     return migration_;
 }
 
+BackfillMigration::BackfillMigration(std::string title, std::string table, std::string statement, BackfillOptions options)
+    : title_(std::move(title)), table_(std::move(table)), statement_(std::move(statement)), options_(options)
+{
+}
+
+const std::string& BackfillMigration::getTitle() const
+{
+    return title_;
+}
+
+const std::string& BackfillMigration::getTable() const
+{
+    return table_;
+}
+
+const std::string& BackfillMigration::getStatement() const
+{
+    return statement_;
+}
+
+const BackfillOptions& BackfillMigration::getOptions() const
+{
+    return options_;
+}
+
 }// namespace sqlitecpp
\ No newline at end of file
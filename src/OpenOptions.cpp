@@ -0,0 +1,189 @@
+#include "OpenOptions.hpp"
+
+#include "../sqlite/sqlite3.h"
+
+namespace sqlitecpp {
+
+namespace {
+
+const char* toString(JournalMode journal_mode)
+{
+    switch (journal_mode) {
+        case JournalMode::Delete:
+            return "DELETE";
+        case JournalMode::Truncate:
+            return "TRUNCATE";
+        case JournalMode::Persist:
+            return "PERSIST";
+        case JournalMode::Memory:
+            return "MEMORY";
+        case JournalMode::Wal:
+            return "WAL";
+        case JournalMode::Off:
+            return "OFF";
+    }
+    return "DELETE";
+}
+
+const char* toString(Synchronous synchronous)
+{
+    switch (synchronous) {
+        case Synchronous::Off:
+            return "OFF";
+        case Synchronous::Normal:
+            return "NORMAL";
+        case Synchronous::Full:
+            return "FULL";
+        case Synchronous::Extra:
+            return "EXTRA";
+    }
+    return "FULL";
+}
+
+const char* toString(TempStore temp_store)
+{
+    switch (temp_store) {
+        case TempStore::Default:
+            return "DEFAULT";
+        case TempStore::File:
+            return "FILE";
+        case TempStore::Memory:
+            return "MEMORY";
+    }
+    return "DEFAULT";
+}
+
+const char* toString(LockingMode locking_mode)
+{
+    return locking_mode == LockingMode::Exclusive ? "EXCLUSIVE" : "NORMAL";
+}
+
+std::string percentEncode(const std::string& text, const std::string& reserved)
+{
+    static const char* hex = "0123456789ABCDEF";
+
+    std::string encoded;
+    for (const unsigned char c : text) {
+        if (reserved.find(static_cast<char>(c)) != std::string::npos) {
+            encoded += '%';
+            encoded += hex[c >> 4];
+            encoded += hex[c & 0x0F];
+            continue;
+        }
+        encoded += static_cast<char>(c);
+    }
+    return encoded;
+}
+
+}// namespace
+
+OpenOptions OpenOptions::oltpDurable()
+{
+    OpenOptions options;
+    options.journal_mode    = JournalMode::Wal;
+    options.synchronous     = Synchronous::Full;
+    options.cache_size      = -64 * 1024;
+    options.mmap_size       = 256ll * 1024 * 1024;
+    options.temp_store      = TempStore::Memory;
+    options.busy_timeout_ms = 5000;
+    return options;
+}
+
+OpenOptions OpenOptions::bulkLoad()
+{
+    OpenOptions options;
+    options.journal_mode    = JournalMode::Wal;
+    options.synchronous     = Synchronous::Off;
+    options.locking_mode    = LockingMode::Exclusive;
+    options.cache_size      = -256 * 1024;
+    options.temp_store      = TempStore::Memory;
+    options.busy_timeout_ms = 5000;
+    return options;
+}
+
+OpenOptions OpenOptions::readOnlyAnalytics()
+{
+    OpenOptions options;
+    options.read_only       = true;
+    options.cache_size      = -256 * 1024;
+    options.mmap_size       = 1024ll * 1024 * 1024;
+    options.temp_store      = TempStore::Memory;
+    options.busy_timeout_ms = 5000;
+    return options;
+}
+
+int OpenOptions::openFlags(bool create) const
+{
+    int flags = SQLITE_OPEN_URI;
+
+    if (read_only) {
+        flags |= SQLITE_OPEN_READONLY;
+    } else {
+        flags |= SQLITE_OPEN_READWRITE;
+        if (create) {
+            flags |= SQLITE_OPEN_CREATE;
+        }
+    }
+
+    if (no_mutex) {
+        flags |= SQLITE_OPEN_NOMUTEX;
+    }
+
+    return flags;
+}
+
+std::string OpenOptions::uri(const std::filesystem::path& db_path) const
+{
+    if (uri_parameters.empty()) {
+        // Plain file names are accepted as is even with SQLITE_OPEN_URI, as long as they do not start with "file:"
+        const auto path = db_path.string();
+        if (path.rfind("file:", 0) != 0) {
+            return path;
+        }
+    }
+
+    std::string uri = "file:" + percentEncode(db_path.generic_string(), "%?#");
+
+    char separator = '?';
+    for (const auto& [key, value] : uri_parameters) {
+        uri += separator + percentEncode(key, "%&=#") + "=" + percentEncode(value, "%&=#");
+        separator = '&';
+    }
+
+    return uri;
+}
+
+std::vector<std::string> OpenOptions::pragmas() const
+{
+    std::vector<std::string> pragmas;
+
+    // page_size has to go first, switching to WAL fixes the page size of a new database
+    if (page_size) {
+        pragmas.push_back("PRAGMA page_size = " + std::to_string(*page_size) + ";");
+    }
+    if (locking_mode) {
+        pragmas.push_back(std::string("PRAGMA locking_mode = ") + toString(*locking_mode) + ";");
+    }
+    if (journal_mode) {
+        pragmas.push_back(std::string("PRAGMA journal_mode = ") + toString(*journal_mode) + ";");
+    }
+    if (synchronous) {
+        pragmas.push_back(std::string("PRAGMA synchronous = ") + toString(*synchronous) + ";");
+    }
+    if (cache_size) {
+        pragmas.push_back("PRAGMA cache_size = " + std::to_string(*cache_size) + ";");
+    }
+    if (mmap_size) {
+        pragmas.push_back("PRAGMA mmap_size = " + std::to_string(*mmap_size) + ";");
+    }
+    if (temp_store) {
+        pragmas.push_back(std::string("PRAGMA temp_store = ") + toString(*temp_store) + ";");
+    }
+    if (foreign_keys) {
+        pragmas.emplace_back("PRAGMA foreign_keys = ON;");
+    }
+
+    return pragmas;
+}
+
+}// namespace sqlitecpp
@@ -0,0 +1,196 @@
+#include "QueryPlan.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <map>
+
+#include "../sqlite/sqlite3.h"
+
+#include "SqliteException.hpp"
+
+namespace sqlitecpp {
+
+namespace {
+
+bool startsWith(std::string_view text, std::string_view prefix)
+{
+    return text.substr(0, prefix.size()) == prefix;
+}
+
+bool contains(std::string_view text, std::string_view part)
+{
+    return text.find(part) != std::string_view::npos;
+}
+
+bool isFullScan(std::string_view detail)
+{
+    // "SCAN t USING COVERING INDEX i" walks an index and "SCAN CONSTANT ROW" reads nothing; older
+    // SQLite versions spell a plain scan "SCAN TABLE t"
+    return startsWith(detail, "SCAN ") && !contains(detail, " INDEX") && !contains(detail, "CONSTANT ROW");
+}
+
+// Splits sql into lower-case words and the single characters ( ) * , ; for isBareCount
+std::vector<std::string> tokenize(std::string_view sql)
+{
+    std::vector<std::string> tokens;
+    std::string              word;
+
+    const auto finish = [&] {
+        if (!word.empty()) {
+            tokens.push_back(std::move(word));
+            word.clear();
+        }
+    };
+
+    for (const char c : sql) {
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            finish();
+        } else if (c == '(' || c == ')' || c == '*' || c == ',' || c == ';') {
+            finish();
+            tokens.emplace_back(1, c);
+        } else {
+            word += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+    }
+    finish();
+
+    return tokens;
+}
+
+// "SELECT count(*) FROM t": SQLite answers it from the b-tree's page counts although the plan says "SCAN t"
+bool isBareCount(std::string_view sql)
+{
+    static const std::vector<std::string> PREFIX = { "select", "count", "(", "*", ")", "from" };
+
+    auto tokens = tokenize(sql);
+    if (!tokens.empty() && tokens.back() == ";") {
+        tokens.pop_back();
+    }
+
+    // Exactly the prefix and a table name, anything else (WHERE, joins, more columns) really walks rows
+    return tokens.size() == PREFIX.size() + 1 && std::equal(PREFIX.begin(), PREFIX.end(), tokens.begin());
+}
+
+int depthOf(const std::map<int, int>& parents, int id)
+{
+    int depth = 0;
+    for (auto parent = parents.find(id); parent != parents.end() && parent->second != 0; parent = parents.find(parent->second)) {
+        ++depth;
+    }
+    return depth;
+}
+
+}// namespace
+
+const char* toString(QueryPlanIssue issue)
+{
+    switch (issue) {
+        case QueryPlanIssue::FullScan:
+            return "full table scan";
+        case QueryPlanIssue::TempBTree:
+            return "temporary b-tree";
+        case QueryPlanIssue::AutomaticIndex:
+            return "automatic index";
+    }
+    return "unknown";
+}
+
+std::vector<QueryPlanWarning> QueryPlan::warnings() const
+{
+    std::vector<QueryPlanWarning> result;
+
+    // Only a plan whose one node is the count's own scan is exempt, a count in a subquery covers nothing else
+    const bool bare_count = nodes.size() == 1 && isBareCount(sql);
+
+    for (const auto& node : nodes) {
+        const std::string_view detail = node.detail;
+
+        if (isFullScan(detail) && !bare_count) {
+            result.push_back(QueryPlanWarning{ QueryPlanIssue::FullScan, sql, node.detail });
+        } else if (startsWith(detail, "USE TEMP B-TREE")) {
+            result.push_back(QueryPlanWarning{ QueryPlanIssue::TempBTree, sql, node.detail });
+        } else if (contains(detail, "AUTOMATIC")) {
+            result.push_back(QueryPlanWarning{ QueryPlanIssue::AutomaticIndex, sql, node.detail });
+        }
+    }
+
+    return result;
+}
+
+std::string QueryPlan::toString() const
+{
+    std::map<int, int> parents;
+    for (const auto& node : nodes) {
+        parents[node.id] = node.parent;
+    }
+
+    std::string result = "QUERY PLAN\n";
+    for (const auto& node : nodes) {
+        result.append(2 * (depthOf(parents, node.id) + 1), ' ');
+        result += node.detail;
+        result += '\n';
+    }
+    return result;
+}
+
+QueryPlan explainQueryPlan(sqlite3* database, std::string_view sql)
+{
+    const auto explain = "EXPLAIN QUERY PLAN " + std::string(sql);
+
+    sqlite3_stmt* statement = nullptr;
+    if (sqlite3_prepare_v2(database, explain.c_str(), static_cast<int>(explain.size()), &statement, nullptr) != SQLITE_OK) {
+        sqlite3_finalize(statement);
+        throw exception::SqliteException("Failed to explain statement: " + std::string(sqlite3_errmsg(database)));
+    }
+
+    QueryPlan plan{ std::string(sql), {} };
+
+    int result;
+    while ((result = sqlite3_step(statement)) == SQLITE_ROW) {
+        const auto detail = reinterpret_cast<const char*>(sqlite3_column_text(statement, 3));
+        plan.nodes.push_back(QueryPlanNode{ sqlite3_column_int(statement, 0), sqlite3_column_int(statement, 1), detail ? detail : "" });
+    }
+
+    sqlite3_finalize(statement);
+    if (result != SQLITE_DONE) {
+        throw exception::SqliteException("Failed to explain statement: " + std::string(sqlite3_errmsg(database)));
+    }
+
+    return plan;
+}
+
+std::vector<ScanStatus> scanStatus([[maybe_unused]] sqlite3_stmt* statement)
+{
+    std::vector<ScanStatus> result;
+
+#ifdef SQLITE_ENABLE_STMT_SCANSTATUS
+    for (int index = 0;; ++index) {
+        sqlite3_int64 loops = 0;
+        if (sqlite3_stmt_scanstatus(statement, index, SQLITE_SCANSTAT_NLOOP, &loops) != 0) {
+            break;
+        }
+
+        ScanStatus status;
+        status.loops = loops;
+
+        sqlite3_int64 visited = 0;
+        sqlite3_stmt_scanstatus(statement, index, SQLITE_SCANSTAT_NVISIT, &visited);
+        status.rows_visited = visited;
+        sqlite3_stmt_scanstatus(statement, index, SQLITE_SCANSTAT_EST, &status.estimated_rows);
+
+        const char* text = nullptr;
+        if (sqlite3_stmt_scanstatus(statement, index, SQLITE_SCANSTAT_NAME, &text) == 0 && text) {
+            status.name = text;
+        }
+        if (sqlite3_stmt_scanstatus(statement, index, SQLITE_SCANSTAT_EXPLAIN, &text) == 0 && text) {
+            status.explain = text;
+        }
+
+        result.push_back(std::move(status));
+    }
+#endif
+
+    return result;
+}
+
+}// namespace sqlitecpp
@@ -0,0 +1,200 @@
+#include "ResultSet.hpp"
+
+#include <cstring>
+#include <limits>
+
+#include "../sqlite/sqlite3.h"
+
+#include "SqliteException.hpp"
+
+namespace sqlitecpp {
+
+namespace {
+
+// First arena block; later blocks grow geometrically, so even large results end up in a few blocks
+constexpr size_t INITIAL_ARENA_BYTES = 16 * 1024;
+
+// Cell sizes are stored as uint32_t; SQLite reports them as int, which always fits once it is non-negative
+static_assert(std::numeric_limits<int>::max() <= std::numeric_limits<uint32_t>::max());
+
+uint32_t cellSize(int bytes)
+{
+    if (bytes < 0) {
+        throw exception::SqliteException("Invalid cell size " + std::to_string(bytes));
+    }
+    return static_cast<uint32_t>(bytes);
+}
+
+}// namespace
+
+ResultSet::Storage::Storage(std::pmr::memory_resource* upstream)
+    : arena(INITIAL_ARENA_BYTES, upstream), cells(&arena)
+{
+}
+
+ResultSet::Row::Row(const ResultSet* result_set, size_t row_index)
+    : result_set_(result_set), first_cell_(row_index * result_set->header_->size())
+{
+}
+
+bool ResultSet::Row::isNull(size_t index) const
+{
+    return result_set_->cell(first_cell_, index).type == CellType::Null;
+}
+
+ResultSet::Iterator::Iterator(const ResultSet* result_set, size_t row_index)
+    : result_set_(result_set), row_index_(row_index)
+{
+}
+
+ResultSet::Row ResultSet::Iterator::operator*() const
+{
+    return Row(result_set_, row_index_);
+}
+
+ResultSet::Iterator& ResultSet::Iterator::operator++()
+{
+    ++row_index_;
+    return *this;
+}
+
+bool ResultSet::Iterator::operator==(const Iterator& other) const
+{
+    return result_set_ == other.result_set_ && row_index_ == other.row_index_;
+}
+
+bool ResultSet::Iterator::operator!=(const Iterator& other) const
+{
+    return !(*this == other);
+}
+
+ResultSet::ResultSet(CachedStatement statement, std::pmr::memory_resource* upstream)
+    : storage_(std::make_unique<Storage>(upstream))
+{
+    sqlite3_stmt* raw_statement = statement.get();
+    const int     column_count  = sqlite3_column_count(raw_statement);
+
+    std::vector<std::string> names;
+    for (int i = 0; i < column_count; ++i) {
+        names.emplace_back(sqlite3_column_name(raw_statement, i));
+    }
+    header_ = std::make_shared<const ColumnHeader>(std::move(names));
+
+    int result;
+    while ((result = sqlite3_step(raw_statement)) == SQLITE_ROW) {
+        for (int i = 0; i < column_count; ++i) {
+            Cell cell;
+
+            switch (sqlite3_column_type(raw_statement, i)) {
+                case SQLITE_INTEGER:
+                    cell.type    = CellType::Integer;
+                    cell.integer = sqlite3_column_int64(raw_statement, i);
+                    break;
+                case SQLITE_FLOAT:
+                    cell.type = CellType::Real;
+                    cell.real = sqlite3_column_double(raw_statement, i);
+                    break;
+                case SQLITE_TEXT:
+                case SQLITE_BLOB: {
+                    const bool is_text = sqlite3_column_type(raw_statement, i) == SQLITE_TEXT;
+                    const auto source  = is_text ? static_cast<const void*>(sqlite3_column_text(raw_statement, i))
+                                                 : sqlite3_column_blob(raw_statement, i);
+                    const auto size    = cellSize(sqlite3_column_bytes(raw_statement, i));
+
+                    auto bytes = static_cast<char*>(storage_->arena.allocate(size, 1));
+                    if (size > 0) {
+                        std::memcpy(bytes, source, size);
+                    }
+
+                    cell.type  = is_text ? CellType::Text : CellType::Blob;
+                    cell.size  = size;
+                    cell.bytes = bytes;
+                    break;
+                }
+                default:
+                    cell.type    = CellType::Null;
+                    cell.integer = 0;
+                    break;
+            }
+
+            storage_->cells.push_back(cell);
+        }
+        ++row_count_;
+    }
+
+    if (result != SQLITE_DONE) {
+        throw exception::SqliteException("Error querying database: " + std::string(sqlite3_errmsg(sqlite3_db_handle(raw_statement))));
+    }
+}
+
+size_t ResultSet::size() const
+{
+    return row_count_;
+}
+
+bool ResultSet::empty() const
+{
+    return row_count_ == 0;
+}
+
+ResultSet::Row ResultSet::operator[](size_t row_index) const
+{
+    if (row_index >= row_count_) {
+        throw exception::SqliteException("Row not found");
+    }
+    return Row(this, row_index);
+}
+
+ResultSet::Iterator ResultSet::begin() const
+{
+    return Iterator(this, 0);
+}
+
+ResultSet::Iterator ResultSet::end() const
+{
+    return Iterator(this, row_count_);
+}
+
+const ColumnHeader& ResultSet::header() const
+{
+    return *header_;
+}
+
+ColumnHandle ResultSet::column(const std::string& column_name) const
+{
+    return header_->handle(column_name);
+}
+
+const ResultSet::Cell& ResultSet::cell(size_t first_cell, size_t index) const
+{
+    if (index >= header_->size()) {
+        throw exception::SqliteException("Column not found");
+    }
+    return storage_->cells[first_cell + index];
+}
+
+detail::CellValue ResultSet::cellValue(size_t first_cell, size_t index) const
+{
+    const auto&       stored = cell(first_cell, index);
+    detail::CellValue value;
+    value.type = stored.type;
+
+    switch (stored.type) {
+        case CellType::Integer:
+            value.integer = stored.integer;
+            break;
+        case CellType::Real:
+            value.real = stored.real;
+            break;
+        case CellType::Text:
+        case CellType::Blob:
+            value.bytes = std::string_view(stored.bytes, stored.size);
+            break;
+        default:
+            break;
+    }
+
+    return value;
+}
+
+}// namespace sqlitecpp
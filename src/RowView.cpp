@@ -0,0 +1,67 @@
+#include "RowView.hpp"
+
+#include "SqliteException.hpp"
+
+#include "../sqlite/sqlite3.h"
+
+namespace sqlitecpp {
+
+RowView::RowView(const CachedStatement& statement, const ColumnHeader& header) : statement_(&statement), header_(&header)
+{
+}
+
+bool RowView::isNull(size_t index) const
+{
+    return statement_->isNull(column(index));
+}
+
+size_t RowView::size() const
+{
+    return header_->size();
+}
+
+const ColumnHeader& RowView::header() const
+{
+    return *header_;
+}
+
+int RowView::column(size_t index) const
+{
+    if (index >= header_->size()) {
+        throw exception::SqliteException("Column not found");
+    }
+    return static_cast<int>(index);
+}
+
+detail::CellValue RowView::cellValue(size_t index) const
+{
+    const int         col = column(index);
+    detail::CellValue value;
+
+    switch (sqlite3_column_type(statement_->get(), col)) {
+        case SQLITE_INTEGER:
+            value.type    = detail::CellType::Integer;
+            value.integer = statement_->columnInt64(col);
+            break;
+        case SQLITE_FLOAT:
+            value.type = detail::CellType::Real;
+            value.real = statement_->columnDouble(col);
+            break;
+        case SQLITE_TEXT:
+            value.type  = detail::CellType::Text;
+            value.bytes = statement_->columnText(col);
+            break;
+        case SQLITE_BLOB: {
+            const auto blob = statement_->columnBlob(col);
+            value.type      = detail::CellType::Blob;
+            value.bytes     = std::string_view(reinterpret_cast<const char*>(blob.data), blob.size);
+            break;
+        }
+        default:
+            break;
+    }
+
+    return value;
+}
+
+}// namespace sqlitecpp
@@ -0,0 +1,173 @@
+#include "SlowQueryLog.hpp"
+
+#include <ctime>
+#include <sstream>
+
+#include "JsonEscape.hpp"
+#include "SqliteException.hpp"
+
+namespace sqlitecpp {
+
+namespace {
+
+std::string timestamp(std::chrono::system_clock::time_point time)
+{
+    const auto seconds      = std::chrono::system_clock::to_time_t(time);
+    const auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count() % 1000;
+
+    std::tm utc{};
+    gmtime_r(&seconds, &utc);
+
+    char text[32];
+    const auto length = std::strftime(text, sizeof(text), "%Y-%m-%dT%H:%M:%S", &utc);
+    std::snprintf(text + length, sizeof(text) - length, ".%03dZ", static_cast<int>(milliseconds));
+    return text;
+}
+
+std::string formatLine(const SlowQuery& query)
+{
+    std::ostringstream thread;
+    thread << query.thread;
+
+    char duration[32];
+    std::snprintf(duration, sizeof(duration), "%.3f", std::chrono::duration<double, std::milli>(query.duration).count());
+
+    std::string line = "{\"time\":\"" + timestamp(query.finished_at) + "\",\"duration_ms\":" + duration
+                     + ",\"rows_returned\":" + std::to_string(query.rows_returned)
+                     + ",\"rows_changed\":" + std::to_string(query.rows_changed) + ",\"thread\":\"" + thread.str()
+                     + "\",\"busy\":" + (query.waited_on_busy ? "true" : "false") + ",\"sql\":\"";
+    detail::appendJsonEscaped(line, query.sql);
+    line += "\"}\n";
+    return line;
+}
+
+}// namespace
+
+SlowQueryLog::SlowQueryLog(SlowQueryLogOptions options) : options_(std::move(options))
+{
+    file_.open(options_.path, std::ios::app);
+    if (!file_) {
+        throw exception::SqliteException("Could not open slow query log " + options_.path.string());
+    }
+
+    std::error_code error;
+    file_bytes_ = std::filesystem::file_size(options_.path, error);
+    if (error) {
+        file_bytes_ = 0;
+    }
+
+    flusher_ = std::thread(&SlowQueryLog::run, this);
+}
+
+SlowQueryLog::~SlowQueryLog()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    flusher_.join();
+}
+
+std::chrono::nanoseconds SlowQueryLog::threshold() const
+{
+    return options_.threshold;
+}
+
+void SlowQueryLog::record(SlowQuery query)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (pending_.size() >= options_.max_pending) {
+        ++dropped_;
+        return;
+    }
+    pending_.push_back(std::move(query));
+}
+
+void SlowQueryLog::flush()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    const auto request = ++flush_requests_;
+    wake_.notify_one();
+    flushed_.wait(lock, [&] { return flushes_finished_ >= request; });
+}
+
+uint64_t SlowQueryLog::dropped() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dropped_;
+}
+
+void SlowQueryLog::run()
+{
+    std::vector<SlowQuery> batch;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        wake_.wait_for(lock, options_.flush_interval, [&] { return stopping_ || flush_requests_ > flushes_finished_; });
+
+        // Swap the buffers so the query path is only held up for the swap, never for the file write
+        batch.swap(pending_);
+        const auto requests = flush_requests_;
+        const auto stopping = stopping_;
+
+        lock.unlock();
+        if (!batch.empty()) {
+            write(batch);
+            batch.clear();
+        }
+        lock.lock();
+
+        flushes_finished_ = requests;
+        flushed_.notify_all();
+
+        if (stopping && pending_.empty()) {
+            return;
+        }
+    }
+}
+
+void SlowQueryLog::write(const std::vector<SlowQuery>& queries)
+{
+    for (const auto& query : queries) {
+        const auto line = formatLine(query);
+
+        if (file_bytes_ > 0 && file_bytes_ + line.size() > options_.max_file_bytes) {
+            rotate();
+        }
+
+        file_ << line;
+        file_bytes_ += line.size();
+    }
+    file_.flush();
+}
+
+void SlowQueryLog::rotate()
+{
+    file_.close();
+
+    // path.N-1 becomes path.N and so on, the oldest file falls off the end
+    std::error_code error;
+    const auto      numbered = [&](size_t index) {
+        auto path = options_.path;
+        path += "." + std::to_string(index);
+        return path;
+    };
+
+    if (options_.max_files > 0) {
+        std::filesystem::remove(numbered(options_.max_files), error);
+        for (auto index = options_.max_files; index > 1; --index) {
+            std::filesystem::rename(numbered(index - 1), numbered(index), error);
+        }
+        std::filesystem::rename(options_.path, numbered(1), error);
+    } else {
+        std::filesystem::remove(options_.path, error);
+    }
+
+    file_.open(options_.path, std::ios::trunc);
+    file_bytes_ = 0;
+}
+
+}// namespace sqlitecpp
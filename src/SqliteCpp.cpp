@@ -1,134 +1,506 @@
 #include "SqliteCpp.hpp"
 
+#include <algorithm>
 #include <iostream>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "../sqlite/sqlite3.h"//todo: fix once the other sqlite thingy is gone :D
 
+#include "Cursor.hpp"
 #include "SqliteException.hpp"
 #include "SqliteRow.hpp"
 
 namespace sqlitecpp {
 
-SqliteCpp SqliteCpp::createOrOpenDatabase(const std::filesystem::path& db_path)
+namespace {
+
+// Upper bound of rows per multi-row VALUES statement, on top of SQLITE_LIMIT_VARIABLE_NUMBER
+constexpr size_t MAX_ROWS_PER_UPSERT = 256;
+
+// sqlite3_bind_blob64 binds NULL for a null pointer, which an empty std::vector may hand out
+void bindBlob(sqlite3_stmt* statement, int param_index, const void* data, size_t size, sqlite3_destructor_type destructor)
+{
+    if (size == 0) {
+        sqlite3_bind_zeroblob64(statement, param_index, 0);
+        return;
+    }
+    sqlite3_bind_blob64(statement, param_index, data, size, destructor);
+}
+
+void bindData(sqlite3_stmt* statement, int param_index, const SqliteData& data, sqlite3_destructor_type destructor)
+{
+    if (std::holds_alternative<int>(data)) {
+        sqlite3_bind_int(statement, param_index, std::get<int>(data));
+        return;
+    }
+
+    if (std::holds_alternative<int64_t>(data)) {
+        sqlite3_bind_int64(statement, param_index, std::get<int64_t>(data));
+        return;
+    }
+
+    if (std::holds_alternative<double>(data)) {
+        sqlite3_bind_double(statement, param_index, std::get<double>(data));
+        return;
+    }
+
+    if (std::holds_alternative<std::string>(data)) {
+        const auto& text = std::get<std::string>(data);
+        sqlite3_bind_text64(statement, param_index, text.data(), text.size(), destructor, SQLITE_UTF8);
+        return;
+    }
+
+    if (std::holds_alternative<SqliteTextView>(data)) {
+        const auto& text = std::get<SqliteTextView>(data).text;
+        sqlite3_bind_text64(statement, param_index, text.data(), text.size(), destructor, SQLITE_UTF8);
+        return;
+    }
+
+    if (std::holds_alternative<SqliteBlobView>(data)) {
+        const auto& blob = std::get<SqliteBlobView>(data);
+        bindBlob(statement, param_index, blob.data, blob.size, destructor);
+        return;
+    }
+
+    if (std::holds_alternative<std::vector<std::byte>>(data)) {
+        const auto& blob = std::get<std::vector<std::byte>>(data);
+        bindBlob(statement, param_index, blob.data(), blob.size(), destructor);
+        return;
+    }
+
+    if (std::holds_alternative<SqliteZeroBlob>(data)) {
+        sqlite3_bind_zeroblob64(statement, param_index, std::get<SqliteZeroBlob>(data).size);
+        return;
+    }
+
+    if (std::holds_alternative<nullptr_t>(data)) {
+        sqlite3_bind_null(statement, param_index);
+        return;
+    }
+
+    throw exception::SqliteException("Invalid data type");
+}
+
+uint64_t dataBytes(const SqliteData& data)
+{
+    if (std::holds_alternative<std::string>(data)) {
+        return std::get<std::string>(data).size();
+    }
+    if (std::holds_alternative<SqliteTextView>(data)) {
+        return std::get<SqliteTextView>(data).text.size();
+    }
+    if (std::holds_alternative<SqliteBlobView>(data)) {
+        return std::get<SqliteBlobView>(data).size;
+    }
+    if (std::holds_alternative<std::vector<std::byte>>(data)) {
+        return std::get<std::vector<std::byte>>(data).size();
+    }
+    return 0;
+}
+
+uint64_t rowBytes(const std::map<std::string, SqliteData>& column_to_data)
+{
+    uint64_t bytes = 0;
+    for (const auto& [column, data] : column_to_data) {
+        bytes += dataBytes(data);
+    }
+    return bytes;
+}
+
+uint64_t rowBytes(const SqliteRow& row)
+{
+    uint64_t bytes = 0;
+    for (size_t i = 0; i < row.size(); ++i) {
+        const auto& cell = row.cell(i);
+        if (std::holds_alternative<std::string>(cell)) {
+            bytes += std::get<std::string>(cell).size();
+        } else if (std::holds_alternative<std::vector<std::byte>>(cell)) {
+            bytes += std::get<std::vector<std::byte>>(cell).size();
+        }
+    }
+    return bytes;
+}
+
+int bindParameters(
+    sqlite3_stmt*                            statement,
+    const std::map<std::string, SqliteData>& column_to_data,
+    sqlite3_destructor_type                  destructor  = SQLITE_STATIC,
+    int                                      param_index = 1)
+{
+    for (const auto& [column, data] : column_to_data) {
+        bindData(statement, param_index, data, destructor);
+        ++param_index;
+    }
+    return param_index;
+}
+
+std::string buildSelectQuery(
+    const std::string&                       table,
+    const std::vector<std::string>&          columns,
+    const std::map<std::string, SqliteData>& where_clauses)
 {
-    return SqliteCpp(db_path);
+    std::string query = "SELECT ";
+    for (const auto& column : columns) {
+        query += column + ", ";
+    }
+    query.erase(query.size() - 2);
+    query += " FROM " + table;
+
+    if (!where_clauses.empty()) {
+        query += " WHERE ";
+
+        for (const auto& where_clause : where_clauses) {
+            query += where_clause.first + " = ? AND ";
+        }
+        query.erase(query.size() - 5);
+    }
+
+    return query;
 }
 
-SqliteCpp SqliteCpp::openDatabase(const std::filesystem::path& db_path)
+std::vector<std::string> columnNames(const std::map<std::string, SqliteData>& column_to_data)
+{
+    std::vector<std::string> columns;
+    columns.reserve(column_to_data.size());
+
+    for (const auto& [column, data] : column_to_data) {
+        columns.push_back(column);
+    }
+    return columns;
+}
+
+bool hasSameColumns(const std::map<std::string, SqliteData>& lhs, const std::map<std::string, SqliteData>& rhs)
+{
+    if (lhs.size() != rhs.size()) {
+        return false;
+    }
+
+    for (auto lhs_it = lhs.begin(), rhs_it = rhs.begin(); lhs_it != lhs.end(); ++lhs_it, ++rhs_it) {
+        if (lhs_it->first != rhs_it->first) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void logQueryPlanWarning(const QueryPlanWarning& warning)
+{
+    fprintf(stderr, "Query plan warning (%s): %s in %s\n", toString(warning.issue), warning.detail.c_str(), warning.sql.c_str());
+}
+
+}// namespace
+
+// Target of the sqlite3_trace_v2 callback and the busy handler. It lives on the heap so the pointer registered
+// with SQLite stays valid when the connection is moved.
+struct SqliteCpp::Tracing
+{
+    struct Execution
+    {
+        uint64_t rows          = 0;
+        int      total_changes = 0;// sqlite3_total_changes when the execution started
+        int64_t  started_ns    = 0;// trace::now() when the execution started, if trace events are recorded
+    };
+
+    std::unique_ptr<StatementStats>              statement_stats;
+    std::shared_ptr<SlowQueryLog>                slow_query_log;// shared by all connections of a pool
+    std::unordered_map<sqlite3_stmt*, Execution> executions;// executions still running
+    int                                          busy_timeout_ms    = 0;
+    bool                                         waited_on_busy     = false;
+    uint64_t                                     trace_connection   = 0;// set when trace events are recorded
+    int                                          wal_autocheckpoint = 1000;// SQLite's default
+};
+
+int SqliteCpp::onTrace(unsigned event, void* context, void* statement_pointer, void* detail)
+{
+    auto& tracing   = *static_cast<Tracing*>(context);
+    auto  statement = static_cast<sqlite3_stmt*>(statement_pointer);
+
+    if (event == SQLITE_TRACE_STMT) {
+        // Triggers report their start as "-- trigger name" on the statement that fired them
+        if (std::string_view(static_cast<const char*>(detail)).substr(0, 2) == "--") {
+            return 0;
+        }
+        auto& execution         = tracing.executions[statement];
+        execution.rows          = 0;
+        execution.total_changes = sqlite3_total_changes(sqlite3_db_handle(statement));
+
+        if (tracing.trace_connection != 0) {
+            execution.started_ns = trace::now();
+            trace::setCurrentConnection(tracing.trace_connection);
+        }
+        return 0;
+    }
+    if (event == SQLITE_TRACE_ROW) {
+        ++tracing.executions[statement].rows;
+        return 0;
+    }
+
+    Tracing::Execution execution;
+    if (const auto found = tracing.executions.find(statement); found != tracing.executions.end()) {
+        execution = found->second;
+        tracing.executions.erase(found);
+    }
+    const auto rows = execution.rows;
+
+    const auto elapsed_ns     = *static_cast<sqlite3_int64*>(detail);
+    const auto waited_on_busy = std::exchange(tracing.waited_on_busy, false);
+
+    if (tracing.statement_stats) {
+        tracing.statement_stats->onProfile(statement, elapsed_ns, rows);
+    }
+
+    if (tracing.trace_connection != 0 && execution.started_ns != 0) {
+        trace::record("statement", "sqlite", execution.started_ns, trace::now(), tracing.trace_connection, sqlite3_sql(statement));
+    }
+
+    if (tracing.slow_query_log && std::chrono::nanoseconds(elapsed_ns) >= tracing.slow_query_log->threshold()) {
+        SlowQuery query;
+        query.finished_at    = std::chrono::system_clock::now();
+        query.duration       = std::chrono::nanoseconds(elapsed_ns);
+        query.rows_returned  = rows;
+        query.rows_changed   = sqlite3_total_changes(sqlite3_db_handle(statement)) - execution.total_changes;
+        query.thread         = std::this_thread::get_id();
+        query.waited_on_busy = waited_on_busy;
+
+        if (auto expanded = sqlite3_expanded_sql(statement)) {
+            query.sql = expanded;
+            sqlite3_free(expanded);
+        } else {
+            query.sql = sqlite3_sql(statement);
+        }
+
+        tracing.slow_query_log->record(std::move(query));
+    }
+
+    return 0;
+}
+
+int SqliteCpp::onBusy(void* context, int count)
+{
+    // Same schedule as sqlite3_busy_timeout, which this handler replaces to see that a statement waited
+    static constexpr int DELAYS_MS[] = { 1, 2, 5, 10, 15, 20, 25, 25, 25, 50, 50, 100 };
+    static constexpr int DELAY_COUNT = sizeof(DELAYS_MS) / sizeof(DELAYS_MS[0]);
+
+    auto& tracing          = *static_cast<Tracing*>(context);
+    tracing.waited_on_busy = true;
+
+    int waited = 0;
+    for (int i = 0; i < std::min(count, DELAY_COUNT); ++i) {
+        waited += DELAYS_MS[i];
+    }
+    waited += std::max(0, count - DELAY_COUNT) * DELAYS_MS[DELAY_COUNT - 1];
+
+    if (waited >= tracing.busy_timeout_ms) {
+        return 0;
+    }
+
+    sqlite3_sleep(std::min(DELAYS_MS[std::min(count, DELAY_COUNT - 1)], tracing.busy_timeout_ms - waited));
+    return 1;
+}
+
+int SqliteCpp::onWalCommit(void* context, sqlite3* database, const char* schema, int pages)
+{
+    // Registering a WAL hook replaces SQLite's automatic checkpoints, so this runs the same passive checkpoint
+    auto& tracing = *static_cast<Tracing*>(context);
+    if (tracing.wal_autocheckpoint <= 0 || pages < tracing.wal_autocheckpoint) {
+        return SQLITE_OK;
+    }
+
+    const auto started = trace::now();
+    sqlite3_wal_checkpoint_v2(database, schema, SQLITE_CHECKPOINT_PASSIVE, nullptr, nullptr);
+    trace::record("checkpoint", "wal", started, trace::now(), tracing.trace_connection, schema);
+
+    return SQLITE_OK;
+}
+
+SqliteCpp SqliteCpp::createOrOpenDatabase(const std::filesystem::path& db_path, const OpenOptions& options)
+{
+    return SqliteCpp(db_path, options, true);
+}
+
+SqliteCpp SqliteCpp::openDatabase(const std::filesystem::path& db_path, const OpenOptions& options)
 {
     if (!std::filesystem::exists(db_path)) {
         throw exception::SqliteException("Database file does not exist");
     }
-    return SqliteCpp(db_path);
+    return SqliteCpp(db_path, options, false);
+}
+
+SqliteCpp::SqliteCpp(const std::filesystem::path& db_path, const OpenOptions& options, bool create)
+    : SqliteCpp(db_path, options, create, nullptr)
+{
 }
 
-SqliteCpp::SqliteCpp(const std::filesystem::path& db_path)
+SqliteCpp::SqliteCpp(
+    const std::filesystem::path&  db_path,
+    const OpenOptions&            options,
+    bool                          create,
+    std::shared_ptr<SlowQueryLog> slow_query_log)
 {
     int rc;
 
-    rc = sqlite3_open(db_path.c_str(), &database_);
+    // Created first, opening the slow query log may throw
+    if (options.statement_stats || options.slow_query_log || options.trace_events) {
+        tracing_ = std::make_unique<Tracing>();
+        if (options.statement_stats) {
+            tracing_->statement_stats = std::make_unique<StatementStats>();
+        }
+        if (slow_query_log) {
+            tracing_->slow_query_log = std::move(slow_query_log);
+        } else if (options.slow_query_log) {
+            tracing_->slow_query_log = std::make_shared<SlowQueryLog>(*options.slow_query_log);
+        }
+        if (options.trace_events) {
+            tracing_->trace_connection = trace::nextConnectionId();
+        }
+        tracing_->busy_timeout_ms = options.busy_timeout_ms.value_or(0);
+    }
+
+    const auto vfs = options.trace_events ? trace::vfsName() : nullptr;
+
+    rc = sqlite3_open_v2(options.uri(db_path).c_str(), &database_, options.openFlags(create), vfs);
     if (rc) {
         fprintf(stderr, "Can't open database: %s\n", sqlite3_errmsg(database_));
         sqlite3_close(database_);
         throw exception::SqliteException("Could not open database");
     }
 
-    // Enable foreign key constraints
-    char* errmsg;
-    rc = sqlite3_exec(database_, "PRAGMA foreign_keys = ON;", nullptr, nullptr, &errmsg);
-    if (rc != SQLITE_OK) {
-        fprintf(stderr, "SQL error: %s\n", errmsg);
-        sqlite3_free(errmsg);
-        sqlite3_close(database_);
-        throw exception::SqliteException("Could not enable foreign key constraints");
+    if (tracing_) {
+        sqlite3_trace_v2(database_, SQLITE_TRACE_STMT | SQLITE_TRACE_PROFILE | SQLITE_TRACE_ROW, onTrace, tracing_.get());
+        if (tracing_->slow_query_log) {
+            sqlite3_busy_handler(database_, onBusy, tracing_.get());
+        } else if (options.busy_timeout_ms) {
+            sqlite3_busy_timeout(database_, *options.busy_timeout_ms);
+        }
+    } else if (options.busy_timeout_ms) {
+        sqlite3_busy_timeout(database_, *options.busy_timeout_ms);
+    }
+
+    // Apply the tuning pragmas and enable foreign key constraints
+    for (const auto& pragma : options.pragmas()) {
+        char* errmsg;
+        rc = sqlite3_exec(database_, pragma.c_str(), nullptr, nullptr, &errmsg);
+        if (rc != SQLITE_OK) {
+            fprintf(stderr, "SQL error: %s\n", errmsg);
+            sqlite3_free(errmsg);
+            sqlite3_close(database_);
+            throw exception::SqliteException("Could not apply " + pragma);
+        }
+    }
+
+    statement_cache_ = std::make_unique<StatementCache>(database_);
+
+    if (options.trace_events) {
+        statement_cache_->setTraceConnection(tracing_->trace_connection);
+        sqlite3_wal_hook(database_, onWalCommit, tracing_.get());
+    }
+
+    if (options.inspect_query_plans) {
+        statement_cache_->setPlanInspection(options.query_plan_handler ? options.query_plan_handler : logQueryPlanWarning);
     }
 }
 
-SqliteCpp::SqliteCpp(SqliteCpp&& other) noexcept : database_(other.database_)
+SqliteCpp::SqliteCpp(SqliteCpp&& other) noexcept
+    : database_(other.database_),
+      statement_cache_(std::move(other.statement_cache_)),
+      tracing_(std::move(other.tracing_)),
+      transaction_depth_(other.transaction_depth_)
 {
     other.database_ = nullptr;
 }
 
 SqliteCpp& SqliteCpp::operator=(SqliteCpp&& other) noexcept
 {
-    if (this != &other) {                 // 1. Self-assignment check
-        sqlite3_close(database_);         // 2. Close current database if it's open
-        database_       = other.database_;// 3. Acquire ownership of the source's database handle
-        other.database_ = nullptr;        // 4. Ensure the source gives up ownership
+    if (this != &other) {                                      // 1. Self-assignment check
+        close();                                               // 2. Close the current database like the destructor
+        database_          = other.database_;                  // 3. Acquire ownership of the source's database handle
+        statement_cache_   = std::move(other.statement_cache_);// 4. ...and of the statements prepared on it
+        tracing_           = std::move(other.tracing_);        // 5. ...and of what its callbacks feed
+        transaction_depth_ = other.transaction_depth_;         // 6. ...and of its open transaction, if any
+        other.database_    = nullptr;                          // 7. Ensure the source gives up ownership
     }
     return *this;
 }
 
 SqliteCpp::~SqliteCpp()
 {
+    close();
+}
+
+void SqliteCpp::close() noexcept
+{
+    statement_cache_.reset();
     if (database_) {
+        // close_v2 may defer closing while statements are still alive, which must no longer reach tracing_
+        sqlite3_trace_v2(database_, 0, nullptr, nullptr);
+        sqlite3_busy_handler(database_, nullptr, nullptr);
+        sqlite3_wal_hook(database_, nullptr, nullptr);
         sqlite3_close_v2(database_);
+        database_ = nullptr;
     }
 }
 
 void SqliteCpp::runMigrations(const std::vector<Migration>& migrations)
 {
-    try {
-        beginTransaction();
-
-        if (!tableExists(MIGRATIONS_TABLE)) {
-            createMigrationsTable();
-        }
+    metrics::Scope scope(metrics::Operation::Migration);
 
-        for (const auto& migration : migrations) {
-            runMigration(migration);
-        }
-
-        commit();
-    } catch (exception::SqliteException& e) {
-        rollback();
-        throw e;
+    // A database that already ran exactly this list is recognized from one row, without reading the applied set
+    const auto schema_hash = migrationsHash(migrations);
+    if (storedMigrationsHash() == schema_hash) {
+        return;
     }
-}
 
-std::vector<SqliteRow> SqliteCpp::selectStarFromTable(const std::string& table) const
-{
-    std::string query = "SELECT * FROM " + table;
+    auto migration_transaction = transaction();
 
-    std::vector<SqliteRow> rows;
+    if (!tableExists(MIGRATIONS_TABLE)) {
+        createMigrationsTable();
+    }
 
-    char* error_message;
+    const auto applied = appliedMigrations();
+    auto       record  = statement_cache_->acquire("INSERT INTO " + MIGRATIONS_TABLE + " (title) VALUES (?);");
 
-    auto response_code = sqlite3_exec(
-        database_,
-        query.c_str(),
-        +[](void* rows_void_ptr, int argc, char** argv, char** column_names) {
-            auto rows_ptr = static_cast<std::vector<SqliteRow>*>(rows_void_ptr);
+    for (const auto& migration : migrations) {
+        if (applied.count(migration.getTitle()) == 0) {
+            runMigration(migration, record);
+            scope.addRows(1);
+        }
+    }
 
-            SqliteRow row;
-            for (size_t i = 0; i < argc; ++i) {
-                const auto                 column_name = std::string(column_names[i]);
-                std::optional<std::string> cell_content;
+    if (!tableExists(META_TABLE)) {
+        createMetaTable();
+    }
+    auto store = statement_cache_->acquire(
+        "INSERT INTO " + META_TABLE + " (key, value) VALUES ('migrations_hash', ?) ON CONFLICT (key) DO UPDATE SET value = excluded.value;");
+    store.bind(1, schema_hash);
+    store.step();
+    store.release();
 
-                if (argv[i] != nullptr) {
-                    cell_content = std::string(argv[i]);
-                }
+    migration_transaction.commit();
+}
 
-                row.add(column_name, cell_content);
-            }
-            rows_ptr->emplace_back(row);
+void SqliteCpp::runBackfills(const std::vector<BackfillMigration>& backfills)
+{
+    if (transaction_depth_ > 0) {
+        throw exception::SqliteException("Backfills commit per chunk and cannot run inside a transaction");
+    }
 
-            return 0;
-        },
-        &rows,
-        &error_message);
+    metrics::Scope scope(metrics::Operation::Migration);
 
-    if (response_code != SQLITE_OK) {
-        std::string exception_message = "Error querying database: ";
-        exception_message += error_message;
-        throw exception::SqliteException(exception_message);
+    if (!tableExists(BACKFILLS_TABLE)) {
+        createBackfillsTable();
     }
 
-    if (error_message) {
-        sqlite3_free(error_message);
+    for (const auto& backfill : backfills) {
+        runBackfill(backfill, scope);
     }
+}
 
-    return rows;
+std::vector<SqliteRow> SqliteCpp::selectStarFromTable(const std::string& table) const
+{
+    return selectFromTableWhere(table);
 }
 
 std::vector<SqliteRow> SqliteCpp::selectFromTableWhere(
@@ -136,137 +508,163 @@ std::vector<SqliteRow> SqliteCpp::selectFromTableWhere(
     const std::vector<std::string>&          columns,
     const std::map<std::string, SqliteData>& where_clauses) const
 {
-    std::string query = "SELECT ";
-    for (const auto& column : columns) {
-        query += column + ", ";
-    }
-    query.erase(query.size() - 2);
-    query += " FROM " + table;
-
-    if (!where_clauses.empty()) {
-        query += " WHERE ";
+    metrics::Scope         scope(metrics::Operation::Select);
+    std::vector<SqliteRow> rows;
 
-        for (const auto& where_clause : where_clauses) {
-            query += where_clause.first + " = ? AND ";
+    for (const auto& row : cursorFromTableWhere(table, columns, where_clauses)) {
+        rows.push_back(row);
+        if constexpr (metrics::ENABLED) {
+            scope.addBytes(rowBytes(row));
         }
-        query.erase(query.size() - 5);
     }
 
-    sqlite3_stmt* statement;
-    auto          preparation_result = sqlite3_prepare_v2(database_, query.c_str(), -1, &statement, nullptr);
+    scope.addRows(rows.size());
+    return rows;
+}
 
-    int param_index = 1;
-    for (const auto& [column, data] : where_clauses) {
-        if (std::holds_alternative<int>(data)) {
-            sqlite3_bind_int(statement, param_index, std::get<int>(data));
-            ++param_index;
-            continue;
-        }
+Cursor SqliteCpp::cursorStarFromTable(const std::string& table) const
+{
+    return cursorFromTableWhere(table);
+}
 
-        if (std::holds_alternative<std::string>(data)) {
-            sqlite3_bind_text(statement, param_index, std::get<std::string>(data).c_str(), -1, SQLITE_STATIC);
-            ++param_index;
-            continue;
-        }
+Cursor SqliteCpp::cursorFromTableWhere(
+    const std::string&                       table,
+    const std::vector<std::string>&          columns,
+    const std::map<std::string, SqliteData>& where_clauses) const
+{
+    auto cached_statement = statement_cache_->acquire(buildSelectQuery(table, columns, where_clauses));
 
-        if (std::holds_alternative<nullptr_t>(data)) {
-            sqlite3_bind_null(statement, param_index);
-            ++param_index;
-            continue;
-        }
+    // The cursor outlives the where clauses, so SQLite has to keep its own copy of bound text and blobs
+    bindParameters(cached_statement.get(), where_clauses, SQLITE_TRANSIENT);
 
-        throw exception::SqliteException("Invalid data type");
-    }
-    std::vector<SqliteRow> rows;
+    return Cursor(std::move(cached_statement));
+}
 
-    // Execute the statement and process the results
-    while (sqlite3_step(statement) == SQLITE_ROW) {
-        SqliteRow row;
+CachedStatement SqliteCpp::statementFromTableWhere(
+    const std::string&                       table,
+    const std::vector<std::string>&          columns,
+    const std::map<std::string, SqliteData>& where_clauses) const
+{
+    auto cached_statement = statement_cache_->acquire(buildSelectQuery(table, columns, where_clauses));
 
-        // Iterate over each column in the result row
-        for (int i = 0; i < sqlite3_column_count(statement); ++i) {
-            std::optional<std::string> cell_content;
-            auto                       column_name = std::string(sqlite3_column_name(statement, i));
+    // Like a cursor, the lease outlives the where clauses
+    bindParameters(cached_statement.get(), where_clauses, SQLITE_TRANSIENT);
 
-            if (sqlite3_column_type(statement, i) != SQLITE_NULL) {
-                cell_content = std::string(reinterpret_cast<const char*>(sqlite3_column_text(statement, i)));
-            }
+    return cached_statement;
+}
 
-            row.add(column_name, cell_content);
-        }
+ResultSet SqliteCpp::resultSetFromTableWhere(
+    const std::string&                       table,
+    const std::vector<std::string>&          columns,
+    const std::map<std::string, SqliteData>& where_clauses,
+    std::pmr::memory_resource*               resource) const
+{
+    metrics::Scope scope(metrics::Operation::Select);
+    auto           result = ResultSet(prepareSelect(table, columns, where_clauses), resource);
 
-        rows.emplace_back(std::move(row));
+    scope.addRows(result.size());
+    return result;
+}
+
+void SqliteCpp::upsert(
+    const std::string&                       table,
+    const std::map<std::string, SqliteData>& column_to_data,
+    const std::vector<std::string>&          conflict_columns)
+{
+    metrics::Scope scope(metrics::Operation::Upsert);
+
+    if (column_to_data.empty()) {
+        throw exception::SqliteException("Cannot upsert empty data");
     }
 
-    // Finalize the statement to avoid resource leaks
-    sqlite3_finalize(statement);
+    auto          cached_statement = statement_cache_->acquire(upsertQuery(table, columnNames(column_to_data), conflict_columns, 1));
+    sqlite3_stmt* statement        = cached_statement.get();
 
-    return rows;
+    bindParameters(statement, column_to_data);
+
+    int result = sqlite3_step(statement);
+
+    if (result != SQLITE_DONE) {
+        throw exception::SqliteException("Error upserting data, Error Code: " + std::to_string(result));
+    }
+
+    scope.addRows(1);
+    if constexpr (metrics::ENABLED) {
+        scope.addBytes(rowBytes(column_to_data));
+    }
 }
 
-void SqliteCpp::upsert(const std::string& table, const std::map<std::string, SqliteData>& column_to_data)
+void SqliteCpp::upsertMany(
+    const std::string&                                    table,
+    const std::vector<std::map<std::string, SqliteData>>& rows,
+    const std::vector<std::string>&                       conflict_columns)
 {
-    if (column_to_data.empty()) {
-        throw exception::SqliteException("Cannot upsert empty data");
+    if (rows.empty()) {
+        return;
     }
 
-    std::string query  = "INSERT OR REPLACE INTO " + table + " (";
-    std::string values = "VALUES (";
+    metrics::Scope scope(metrics::Operation::Upsert);
 
-    for (const auto& [column, data] : column_to_data) {
-        query += (column + ", ");
-        values += "?, ";
+    const auto& columns = rows.front();
+    if (columns.empty()) {
+        throw exception::SqliteException("Cannot upsert empty data");
     }
 
-    query.erase(query.size() - 2);
-    values.erase(values.size() - 2);
+    for (const auto& row : rows) {
+        if (!hasSameColumns(row, columns)) {
+            throw exception::SqliteException("Cannot upsert rows with different columns in one batch");
+        }
+    }
 
-    query += ") " + values + ")";
+    // Pack as many rows into one VALUES list as the bound parameter limit allows
+    const auto variable_limit     = static_cast<size_t>(sqlite3_limit(database_, SQLITE_LIMIT_VARIABLE_NUMBER, -1));
+    const auto rows_per_statement = std::max<size_t>(1, std::min(variable_limit / columns.size(), MAX_ROWS_PER_UPSERT));
 
-    sqlite3_stmt* statement;
-    auto          preparation_result = sqlite3_prepare_v2(database_, query.c_str(), -1, &statement, nullptr);
+    // Nested in the caller's transaction this becomes a savepoint, otherwise the whole batch shares a single commit
+    auto batch_transaction = transaction();
 
-    int param_index = 1;
-    for (const auto& [column, data] : column_to_data) {
-        if (std::holds_alternative<int>(data)) {
-            sqlite3_bind_int(statement, param_index, std::get<int>(data));
-            ++param_index;
-            continue;
+    CachedStatement cached_statement;
+    size_t          prepared_row_count = 0;
+
+    for (size_t first_row = 0; first_row < rows.size(); first_row += rows_per_statement) {
+        const auto row_count = std::min(rows_per_statement, rows.size() - first_row);
+
+        // Every full chunk reuses the same statement, only the tail needs a shorter one
+        if (row_count != prepared_row_count) {
+            cached_statement   = statement_cache_->acquire(upsertQuery(table, columnNames(columns), conflict_columns, row_count));
+            prepared_row_count = row_count;
         }
+        sqlite3_stmt* statement = cached_statement.get();
 
-        if (std::holds_alternative<std::string>(data)) {
-            sqlite3_bind_text(statement, param_index, std::get<std::string>(data).c_str(), -1, SQLITE_STATIC);
-            ++param_index;
-            continue;
+        int param_index = 1;
+        for (size_t i = first_row; i < first_row + row_count; ++i) {
+            param_index = bindParameters(statement, rows[i], SQLITE_STATIC, param_index);
         }
 
-        if (std::holds_alternative<nullptr_t>(data)) {
-            sqlite3_bind_null(statement, param_index);
-            ++param_index;
-            continue;
+        int result = sqlite3_step(statement);
+        if (result != SQLITE_DONE) {
+            throw exception::SqliteException("Error upserting data, Error Code: " + std::to_string(result));
         }
 
-        throw exception::SqliteException("Invalid data type");
+        sqlite3_reset(statement);
+        sqlite3_clear_bindings(statement);
     }
 
-    //    const char* expandedSql = sqlite3_expanded_sql(statement);
-    //    if (expandedSql) {
-    //        std::string success = expandedSql;
-    //        sqlite3_free((void*)expandedSql); // Free the allocated memory
-    //    } else {
-    //        std::string error = "Could not retrieve expanded SQL.";
-    //    }
-
-    int result = sqlite3_step(statement);
-    sqlite3_finalize(statement);
+    cached_statement.release();
+    batch_transaction.commit();
 
-    if (result != SQLITE_DONE) {
-        throw exception::SqliteException("Error upserting data, Error Code: " + std::to_string(result));
+    scope.addRows(rows.size());
+    if constexpr (metrics::ENABLED) {
+        for (const auto& row : rows) {
+            scope.addBytes(rowBytes(row));
+        }
     }
 }
 
 void SqliteCpp::deleteFrom(const std::string& table, const std::map<std::string, SqliteData>& where_clauses)
 {
+    metrics::Scope scope(metrics::Operation::Delete);
+
     if (where_clauses.empty()) {
         throw exception::SqliteException("Cannot delete without where clauses");
     }
@@ -278,38 +676,157 @@ void SqliteCpp::deleteFrom(const std::string& table, const std::map<std::string,
 
     query.erase(query.size() - 5);
 
-    sqlite3_stmt* statement;
-    auto          preparation_result = sqlite3_prepare_v2(database_, query.c_str(), -1, &statement, nullptr);
+    auto          cached_statement = statement_cache_->acquire(query);
+    sqlite3_stmt* statement        = cached_statement.get();
 
-    int param_index = 1;
-    for (const auto& [column, data] : where_clauses) {
-        if (std::holds_alternative<int>(data)) {
-            sqlite3_bind_int(statement, param_index, std::get<int>(data));
-            ++param_index;
-            continue;
-        }
+    bindParameters(statement, where_clauses);
 
-        if (std::holds_alternative<std::string>(data)) {
-            sqlite3_bind_text(statement, param_index, std::get<std::string>(data).c_str(), -1, SQLITE_STATIC);
-            ++param_index;
-            continue;
-        }
+    int result = sqlite3_step(statement);
+
+    if (result != SQLITE_DONE) {
+        throw exception::SqliteException("Error deleting data");
+    }
+
+    scope.addRows(static_cast<uint64_t>(sqlite3_changes(database_)));
+}
+
+BlobStream SqliteCpp::openBlob(const std::string& table, const std::string& column, int64_t rowid, bool writable)
+{
+    sqlite3_blob* blob = nullptr;
+
+    int result = sqlite3_blob_open(database_, "main", table.c_str(), column.c_str(), rowid, writable ? 1 : 0, &blob);
+    if (result != SQLITE_OK) {
+        sqlite3_blob_close(blob);
+        throw exception::SqliteException("Failed to open blob " + table + "." + column + ": " + std::string(sqlite3_errmsg(database_)));
+    }
+
+    return BlobStream(blob, writable);
+}
+
+Transaction SqliteCpp::transaction(TransactionMode mode)
+{
+    return Transaction(*this, mode);
+}
+
+void SqliteCpp::setStatementCacheCapacity(size_t capacity)
+{
+    statement_cache_->setCapacity(capacity);
+}
+
+StatementCacheStats SqliteCpp::statementCacheStats() const
+{
+    return statement_cache_->stats();
+}
+
+QueryPlan SqliteCpp::explainQueryPlan(const std::string& sql) const
+{
+    return sqlitecpp::explainQueryPlan(database_, sql);
+}
+
+std::vector<StatementStatsEntry> SqliteCpp::topStatements(size_t count) const
+{
+    if (!tracing_ || !tracing_->statement_stats) {
+        return {};
+    }
+    return tracing_->statement_stats->top(count);
+}
+
+void SqliteCpp::resetStatementStats()
+{
+    if (tracing_ && tracing_->statement_stats) {
+        tracing_->statement_stats->reset();
+    }
+}
+
+uint64_t SqliteCpp::traceConnection() const
+{
+    return tracing_ ? tracing_->trace_connection : 0;
+}
+
+void SqliteCpp::flushSlowQueryLog()
+{
+    if (tracing_ && tracing_->slow_query_log) {
+        tracing_->slow_query_log->flush();
+    }
+}
+
+std::string SqliteCpp::upsertQuery(
+    const std::string&              table,
+    const std::vector<std::string>& columns,
+    const std::vector<std::string>& conflict_columns,
+    size_t                          row_count)
+{
+    std::string query  = (conflict_columns.empty() ? "INSERT OR REPLACE INTO " : "INSERT INTO ") + table + " (";
+    std::string values = "(";
+
+    for (const auto& column : columns) {
+        query += (column + ", ");
+        values += "?, ";
+    }
+
+    query.erase(query.size() - 2);
+    values.erase(values.size() - 2);
+    values += "), ";
+
+    query += ") VALUES ";
+    query.reserve(query.size() + values.size() * row_count);
+    for (size_t i = 0; i < row_count; ++i) {
+        query += values;
+    }
+    query.erase(query.size() - 2);
+
+    if (conflict_columns.empty()) {
+        return query;
+    }
+
+    // Update the existing row in place: no rowid change, no delete cascade and only the non-key columns are written
+    query += " ON CONFLICT (";
+    for (const auto& column : conflict_columns) {
+        query += column + ", ";
+    }
+    query.erase(query.size() - 2);
+    query += ") DO ";
 
-        if (std::holds_alternative<nullptr_t>(data)) {
-            sqlite3_bind_null(statement, param_index);
-            ++param_index;
-            continue;
+    std::string assignments;
+    for (const auto& column : columns) {
+        if (std::find(conflict_columns.begin(), conflict_columns.end(), column) == conflict_columns.end()) {
+            assignments += column + " = excluded." + column + ", ";
         }
+    }
 
-        throw exception::SqliteException("Invalid data type");
+    if (assignments.empty()) {
+        return query + "NOTHING";
     }
 
-    int result = sqlite3_step(statement);
-    sqlite3_finalize(statement);
+    assignments.erase(assignments.size() - 2);
+    return query + "UPDATE SET " + assignments;
+}
 
-    if (result != SQLITE_DONE) {
-        throw exception::SqliteException("Error deleting data");
+std::string SqliteCpp::insertQuery(const std::string& table, const std::vector<std::string>& columns)
+{
+    std::string query  = "INSERT INTO " + table + " (";
+    std::string values = "VALUES (";
+
+    for (const auto& column : columns) {
+        query += (column + ", ");
+        values += "?, ";
     }
+
+    query.erase(query.size() - 2);
+    values.erase(values.size() - 2);
+
+    return query + ") " + values + ")";
+}
+
+CachedStatement SqliteCpp::prepareSelect(
+    const std::string&                       table,
+    const std::vector<std::string>&          columns,
+    const std::map<std::string, SqliteData>& where_clauses) const
+{
+    auto cached_statement = statement_cache_->acquire(buildSelectQuery(table, columns, where_clauses));
+    bindParameters(cached_statement.get(), where_clauses);
+
+    return cached_statement;
 }
 
 bool SqliteCpp::tableExists(const std::string& tableName) const
@@ -354,62 +871,223 @@ void SqliteCpp::createMigrationsTable()
     }
 }
 
-void SqliteCpp::runMigration(const Migration& migration)
+void SqliteCpp::createMetaTable()
 {
-    const auto& rows = selectStarFromTable(MIGRATIONS_TABLE);
-    for (const auto& row : rows) {
-        if (row.get<std::string>("title") == migration.getTitle()) {
-            return;
-        }
-    }
+    // Library state that is not a migration, e.g. the migrations_hash of the last runMigrations
+    const std::string query = "CREATE TABLE IF NOT EXISTS " + META_TABLE + R"( (
+                key TEXT PRIMARY KEY NOT NULL,
+                value
+            ) WITHOUT ROWID;
+        )";
 
-    char*              errorMessage           = nullptr;
-    const std::string& migrations_table_query = "INSERT INTO " + MIGRATIONS_TABLE + " (title) VALUES ('" + migration.getTitle() + "');";
-    int                result                 = sqlite3_exec(database_, migrations_table_query.c_str(), nullptr, nullptr, &errorMessage);
+    executeStatement(query, "Failed to create meta table");
+}
+
+void SqliteCpp::createBackfillsTable()
+{
+    // Separate from sqlitecpp_migrations, backfill and migration titles are independent. progress is the last
+    // finished rowid while the backfill runs and NULL once it is complete.
+    const std::string query = "CREATE TABLE IF NOT EXISTS " + BACKFILLS_TABLE + R"( (
+                id INTEGER PRIMARY KEY AUTOINCREMENT,
+                title TEXT NOT NULL UNIQUE,
+                progress INTEGER,
+                executed_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP NOT NULL
+            );
+        )";
+
+    executeStatement(query, "Failed to create backfills table");
+}
+
+void SqliteCpp::runMigration(const Migration& migration, CachedStatement& record)
+{
+    record.bind(1, std::string_view(migration.getTitle()));
+    record.step();
+    record.reset();
+
+    char* errorMessage = nullptr;
+    int   result       = sqlite3_exec(database_, migration.getMigration().c_str(), nullptr, nullptr, &errorMessage);
 
     if (result != SQLITE_OK) {
         std::string errorStr(errorMessage);
         sqlite3_free(errorMessage);
         throw exception::SqliteException("SQL execution failed: " + errorStr);
     }
+}
 
-    result = sqlite3_exec(database_, migration.getMigration().c_str(), nullptr, nullptr, &errorMessage);
+void SqliteCpp::runBackfill(const BackfillMigration& backfill, metrics::Scope& scope)
+{
+    static constexpr int64_t MAX_BACKFILL_CHUNK = int64_t(1) << 32;
 
-    if (result != SQLITE_OK) {
-        std::string errorStr(errorMessage);
-        sqlite3_free(errorMessage);
-        throw exception::SqliteException("SQL execution failed: " + errorStr);
+    const auto& options = backfill.getOptions();
+
+    std::optional<int64_t> resume_after;
+    {
+        auto progress = statement_cache_->acquire("SELECT progress FROM " + BACKFILLS_TABLE + " WHERE title = ?;");
+        progress.bind(1, std::string_view(backfill.getTitle()));
+        if (progress.step()) {
+            if (progress.isNull(0)) {
+                return;
+            }
+            resume_after = progress.columnInt64(0);
+        }
     }
+
+    // Rows inserted after this point are left to the code that writes them
+    int64_t first = 0;
+    int64_t last  = -1;
+    {
+        // Separate subqueries, SQLite only answers a lone min() or max() from the end of the b-tree and scans for both
+        const auto& table  = backfill.getTable();
+        auto        bounds = statement_cache_->acquire(
+            "SELECT (SELECT min(rowid) FROM " + table + "), (SELECT max(rowid) FROM " + table + ");");
+        if (bounds.step() && !bounds.isNull(0)) {
+            first = resume_after ? *resume_after + 1 : bounds.columnInt64(0);
+            last  = bounds.columnInt64(1);
+        }
+    }
+
+    auto record = statement_cache_->acquire(
+        "INSERT INTO " + BACKFILLS_TABLE + " (title, progress) VALUES (?1, ?2)"
+        " ON CONFLICT (title) DO UPDATE SET progress = excluded.progress;");
+    auto chunk = statement_cache_->acquire(backfill.getStatement());
+
+    auto chunk_size = std::max<int64_t>(options.chunk_size, 1);
+    while (first <= last) {
+        const auto chunk_last = first + std::min(chunk_size - 1, last - first);
+        const auto started    = std::chrono::steady_clock::now();
+
+        {
+            auto chunk_transaction = transaction(TransactionMode::Immediate);
+
+            chunk.bind(1, first);
+            chunk.bind(2, chunk_last);
+            while (chunk.step()) {
+            }
+            chunk.reset();
+            scope.addRows(static_cast<uint64_t>(sqlite3_changes(database_)));
+
+            record.bind(1, std::string_view(backfill.getTitle()));
+            record.bind(2, chunk_last);
+            record.step();
+            record.reset();
+
+            chunk_transaction.commit();
+        }
+
+        first = chunk_last + 1;
+
+        // Keep chunks near the target time, then stay off the lock so foreground work gets its share
+        const auto elapsed = std::chrono::steady_clock::now() - started;
+        if (elapsed > options.target_chunk_time && chunk_size > 1) {
+            chunk_size /= 2;
+        } else if (elapsed < options.target_chunk_time / 2) {
+            chunk_size = std::min(chunk_size * 2, MAX_BACKFILL_CHUNK);
+        }
+
+        if (options.duty_cycle > 0 && options.duty_cycle < 1) {
+            std::this_thread::sleep_for(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed * ((1 - options.duty_cycle) / options.duty_cycle)));
+        }
+    }
+
+    record.bind(1, std::string_view(backfill.getTitle()));
+    record.bindNull(2);
+    record.step();
+    record.reset();
 }
 
-void SqliteCpp::beginTransaction()
+std::unordered_set<std::string> SqliteCpp::appliedMigrations() const
 {
-    char* errMsg = nullptr;
-    if (sqlite3_exec(database_, "BEGIN TRANSACTION;", nullptr, nullptr, &errMsg) != SQLITE_OK) {
-        std::string errorStr = errMsg;
-        sqlite3_free(errMsg);
-        throw exception::SqliteException("Failed to begin transaction: " + errorStr);
+    std::unordered_set<std::string> titles;
+
+    auto statement = statement_cache_->acquire("SELECT title FROM " + MIGRATIONS_TABLE + ";");
+    while (statement.step()) {
+        titles.emplace(statement.columnText(0));
     }
+
+    return titles;
 }
 
-void SqliteCpp::rollback()
+std::optional<int64_t> SqliteCpp::storedMigrationsHash() const
 {
-    char* errMsg = nullptr;
-    if (sqlite3_exec(database_, "ROLLBACK;", nullptr, nullptr, &errMsg) != SQLITE_OK) {
-        std::string errorStr = errMsg;
-        sqlite3_free(errMsg);
-        throw exception::SqliteException("Failed to begin transaction: " + errorStr);
+    if (!tableExists(META_TABLE)) {
+        return std::nullopt;
     }
+
+    auto statement = statement_cache_->acquire("SELECT value FROM " + META_TABLE + " WHERE key = 'migrations_hash';");
+    if (!statement.step() || statement.isNull(0)) {
+        return std::nullopt;
+    }
+    return statement.columnInt64(0);
 }
 
-void SqliteCpp::commit()
+int64_t SqliteCpp::migrationsHash(const std::vector<Migration>& migrations)
+{
+    // FNV-1a over the titles, which is what decides whether a migration has run
+    uint64_t hash = 14695981039346656037ull;
+    for (const auto& migration : migrations) {
+        for (const char c : migration.getTitle()) {
+            hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+        }
+        hash = (hash ^ 0xff) * 1099511628211ull;
+    }
+
+    return static_cast<int64_t>(hash);
+}
+
+void SqliteCpp::executeStatement(const std::string& query, const std::string& error_context)
 {
     char* errMsg = nullptr;
-    if (sqlite3_exec(database_, "COMMIT;", nullptr, nullptr, &errMsg) != SQLITE_OK) {
+    if (sqlite3_exec(database_, query.c_str(), nullptr, nullptr, &errMsg) != SQLITE_OK) {
         std::string errorStr = errMsg;
         sqlite3_free(errMsg);
-        throw exception::SqliteException("Failed to begin transaction: " + errorStr);
+        throw exception::SqliteException(error_context + ": " + errorStr);
+    }
+}
+
+size_t SqliteCpp::beginTransaction(TransactionMode mode)
+{
+    const auto depth = transaction_depth_;
+
+    if (depth > 0) {
+        executeStatement("SAVEPOINT sqlitecpp_" + std::to_string(depth) + ";", "Failed to create savepoint");
+    } else if (mode == TransactionMode::Immediate) {
+        executeStatement("BEGIN IMMEDIATE TRANSACTION;", "Failed to begin transaction");
+    } else if (mode == TransactionMode::Exclusive) {
+        executeStatement("BEGIN EXCLUSIVE TRANSACTION;", "Failed to begin transaction");
+    } else {
+        executeStatement("BEGIN DEFERRED TRANSACTION;", "Failed to begin transaction");
     }
+
+    ++transaction_depth_;
+    return depth;
+}
+
+void SqliteCpp::rollback(size_t depth)
+{
+    transaction_depth_ = depth;
+
+    if (depth > 0) {
+        const auto savepoint = "sqlitecpp_" + std::to_string(depth);
+        executeStatement("ROLLBACK TO " + savepoint + "; RELEASE " + savepoint + ";", "Failed to roll back savepoint");
+        return;
+    }
+
+    // SQLite already rolled back on its own after errors such as SQLITE_FULL or SQLITE_IOERR
+    if (sqlite3_get_autocommit(database_)) {
+        return;
+    }
+    executeStatement("ROLLBACK;", "Failed to roll back transaction");
+}
+
+void SqliteCpp::commit(size_t depth)
+{
+    if (depth > 0) {
+        executeStatement("RELEASE sqlitecpp_" + std::to_string(depth) + ";", "Failed to release savepoint");
+    } else {
+        executeStatement("COMMIT;", "Failed to commit transaction");
+    }
+
+    transaction_depth_ = depth;
 }
 
-}// namespace sqlitecpp
\ No newline at end of file
+}// namespace sqlitecpp
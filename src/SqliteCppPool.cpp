@@ -0,0 +1,151 @@
+#include "SqliteCppPool.hpp"
+
+#include <algorithm>
+
+#include "SqliteException.hpp"
+
+namespace sqlitecpp {
+
+namespace {
+
+void recordWait(std::chrono::nanoseconds wait, std::chrono::nanoseconds& total, std::chrono::nanoseconds& max)
+{
+    total += wait;
+    max = std::max(max, wait);
+}
+
+}// namespace
+
+SqliteCppPool::Lease::Lease(SqliteCppPool* pool, SqliteCpp* connection, bool is_writer)
+    : pool_(pool), connection_(connection), is_writer_(is_writer), leased_at_(std::chrono::steady_clock::now())
+{
+}
+
+SqliteCppPool::Lease::Lease(Lease&& other) noexcept
+    : pool_(other.pool_), connection_(other.connection_), is_writer_(other.is_writer_), leased_at_(other.leased_at_)
+{
+    other.pool_ = nullptr;
+}
+
+SqliteCppPool::Lease::~Lease()
+{
+    if (pool_) {
+        pool_->release(connection_, is_writer_, std::chrono::steady_clock::now() - leased_at_);
+    }
+}
+
+SqliteCpp& SqliteCppPool::Lease::operator*() const
+{
+    return *connection_;
+}
+
+SqliteCpp* SqliteCppPool::Lease::operator->() const
+{
+    return connection_;
+}
+
+SqliteCppPool::SqliteCppPool(const std::filesystem::path& db_path, size_t reader_count, const OpenOptions& options)
+    : created_at_(std::chrono::steady_clock::now())
+{
+    if (reader_count == 0) {
+        throw exception::SqliteException("Connection pool needs at least one reader");
+    }
+
+    // One log for the whole pool: separate instances would each rotate the same file and interleave their writes
+    std::shared_ptr<SlowQueryLog> slow_query_log;
+    if (options.slow_query_log) {
+        slow_query_log = std::make_shared<SlowQueryLog>(*options.slow_query_log);
+    }
+
+    // The writer creates the file and switches it to WAL, which is what lets readers run next to it
+    auto writer_options         = options;
+    writer_options.read_only    = false;
+    writer_options.no_mutex     = true;
+    writer_options.journal_mode = JournalMode::Wal;
+    writer_.reset(new SqliteCpp(db_path, writer_options, true, slow_query_log));
+
+    // The journal mode is persistent and a read-only connection cannot change it anyway
+    auto reader_options         = options;
+    reader_options.read_only    = true;
+    reader_options.no_mutex     = true;
+    reader_options.journal_mode = std::nullopt;
+    reader_options.page_size    = std::nullopt;
+
+    for (size_t i = 0; i < reader_count; ++i) {
+        readers_.emplace_back(new SqliteCpp(db_path, reader_options, false, slow_query_log));
+        idle_readers_.push_back(readers_.back().get());
+    }
+
+    metrics_.reader_count = reader_count;
+}
+
+SqliteCppPool::Lease SqliteCppPool::read()
+{
+    const auto                   start = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    reader_released_.wait(lock, [this] { return !idle_readers_.empty(); });
+
+    auto connection = idle_readers_.back();
+    idle_readers_.pop_back();
+
+    ++metrics_.read_leases;
+    recordWait(std::chrono::steady_clock::now() - start, metrics_.total_read_wait, metrics_.max_read_wait);
+
+    return Lease(this, connection, false);
+}
+
+SqliteCppPool::Lease SqliteCppPool::write()
+{
+    const auto                   start = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    writer_released_.wait(lock, [this] { return !writer_in_use_; });
+
+    writer_in_use_ = true;
+
+    ++metrics_.write_leases;
+    recordWait(std::chrono::steady_clock::now() - start, metrics_.total_write_wait, metrics_.max_write_wait);
+
+    return Lease(this, writer_.get(), true);
+}
+
+PoolMetrics SqliteCppPool::metrics() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto metrics           = metrics_;
+    metrics.readers_in_use = readers_.size() - idle_readers_.size();
+    metrics.writer_in_use  = writer_in_use_;
+
+    const auto lifetime = std::chrono::duration<double>(std::chrono::steady_clock::now() - created_at_).count();
+    if (lifetime > 0.0) {
+        metrics.reader_utilization = std::chrono::duration<double>(reader_busy_).count() / (lifetime * readers_.size());
+        metrics.writer_utilization = std::chrono::duration<double>(writer_busy_).count() / lifetime;
+    }
+
+    return metrics;
+}
+
+void SqliteCppPool::release(SqliteCpp* connection, bool is_writer, std::chrono::nanoseconds busy)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if (is_writer) {
+            writer_in_use_ = false;
+            writer_busy_ += busy;
+        } else {
+            idle_readers_.push_back(connection);
+            reader_busy_ += busy;
+        }
+    }
+
+    if (is_writer) {
+        writer_released_.notify_one();
+    } else {
+        reader_released_.notify_one();
+    }
+}
+
+}// namespace sqlitecpp
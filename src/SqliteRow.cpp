@@ -4,93 +4,85 @@
 
 namespace sqlitecpp {
 
-void SqliteRow::add(const std::string& column_name, const std::optional<std::string>& cell_content)
+SqliteRow::SqliteRow(std::shared_ptr<const ColumnHeader> header)
+    : header_(std::move(header)), cells_(header_->size())
 {
-    cells_[column_name] = cell_content;
 }
 
-void SqliteRow::guardColumnExists(const std::string& column_name) const
+void SqliteRow::set(size_t index, SqliteCell cell_content)
 {
-    if (cells_.find(column_name) == cells_.end()) {
-        throw exception::SqliteException("Column not found");
-    }
+    cells_.at(index) = std::move(cell_content);
 }
 
-template<>
-size_t SqliteRow::get(const std::string& column_name) const
+void SqliteRow::add(const std::string& column_name, const std::optional<std::string>& cell_content)
 {
-    guardColumnExists(column_name);
-
-    if (!cells_.at(column_name).has_value()) {
-        throw exception::SqliteException("Requested value is null");
+    SqliteCell content = nullptr;
+    if (cell_content) {
+        content = *cell_content;
     }
-    return std::stoul(cells_.at(column_name).value());
-}
 
-template<>
-std::optional<size_t> SqliteRow::get(const std::string& column_name) const
-{
-    guardColumnExists(column_name);
+    if (header_ && header_->contains(column_name)) {
+        set(header_->handle(column_name).index, std::move(content));
+        return;
+    }
 
-    if (!cells_.at(column_name).has_value()) {
-        return std::nullopt;
+    std::vector<std::string> names;
+    for (size_t i = 0; header_ && i < header_->size(); ++i) {
+        names.push_back(header_->name(i));
     }
-    return std::stoul(cells_.at(column_name).value());
+    names.push_back(column_name);
+
+    header_ = std::make_shared<const ColumnHeader>(std::move(names));
+    cells_.push_back(std::move(content));
 }
 
-template<>
-std::optional<double> SqliteRow::get(const std::string& column_name) const
+const SqliteCell& SqliteRow::cell(size_t index) const
 {
-    guardColumnExists(column_name);
-
-    if (!cells_.at(column_name).has_value()) {
-        return std::nullopt;
+    if (index >= cells_.size()) {
+        throw exception::SqliteException("Column not found");
     }
-    return std::stod(cells_.at(column_name).value());
+    return cells_[index];
 }
 
-template<>
-std::optional<std::string> SqliteRow::get(const std::string& column_name) const
+const SqliteCell& SqliteRow::cell(const std::string& column_name) const
 {
-    guardColumnExists(column_name);
-
-    return cells_.at(column_name);
+    return cell(header().handle(column_name).index);
 }
 
-template<>
-std::string SqliteRow::get(const std::string& column_name) const
+const ColumnHeader& SqliteRow::header() const
 {
-    guardColumnExists(column_name);
-
-    if (!cells_.at(column_name).has_value()) {
-        throw exception::SqliteException("Requested value is null");
+    if (!header_) {
+        throw exception::SqliteException("Column not found");
     }
-
-    return cells_.at(column_name).value();
+    return *header_;
 }
 
-template<>
-bool SqliteRow::get(const std::string& column_name) const
+size_t SqliteRow::size() const
 {
-    guardColumnExists(column_name);
-
-    if (!cells_.at(column_name).has_value()) {
-        throw exception::SqliteException("Requested value is null");
-    }
-
-    return cells_.at(column_name).value() == "1";
+    return cells_.size();
 }
 
-template<>
-std::optional<int> SqliteRow::get(const std::string& column_name) const
+detail::CellValue SqliteRow::cellValue(size_t index) const
 {
-    guardColumnExists(column_name);
-
-    if (!cells_.at(column_name).has_value()) {
-        return std::nullopt;
+    const auto&       content = cell(index);
+    detail::CellValue value;
+
+    if (std::holds_alternative<int64_t>(content)) {
+        value.type    = detail::CellType::Integer;
+        value.integer = std::get<int64_t>(content);
+    } else if (std::holds_alternative<double>(content)) {
+        value.type = detail::CellType::Real;
+        value.real = std::get<double>(content);
+    } else if (std::holds_alternative<std::string>(content)) {
+        value.type  = detail::CellType::Text;
+        value.bytes = std::get<std::string>(content);
+    } else if (std::holds_alternative<std::vector<std::byte>>(content)) {
+        const auto& blob = std::get<std::vector<std::byte>>(content);
+        value.type       = detail::CellType::Blob;
+        value.bytes      = std::string_view(reinterpret_cast<const char*>(blob.data()), blob.size());
     }
 
-    return std::stoi(cells_.at(column_name).value());
+    return value;
 }
 
-}// namespace sqlitecpp
\ No newline at end of file
+}// namespace sqlitecpp
@@ -0,0 +1,305 @@
+#include "StatementCache.hpp"
+
+#include "../sqlite/sqlite3.h"
+
+#include "SqliteException.hpp"
+#include "TraceEvents.hpp"
+
+namespace sqlitecpp {
+
+CachedStatement::CachedStatement(StatementCache* cache, sqlite3_stmt* statement, Entry* entry)
+    : cache_(cache), statement_(statement), entry_(entry)
+{
+}
+
+CachedStatement::CachedStatement(CachedStatement&& other) noexcept
+    : cache_(other.cache_), statement_(other.statement_), entry_(other.entry_)
+{
+    other.cache_     = nullptr;
+    other.statement_ = nullptr;
+    other.entry_     = nullptr;
+}
+
+CachedStatement& CachedStatement::operator=(CachedStatement&& other) noexcept
+{
+    if (this != &other) {
+        release();
+        cache_           = other.cache_;
+        statement_       = other.statement_;
+        entry_           = other.entry_;
+        other.cache_     = nullptr;
+        other.statement_ = nullptr;
+        other.entry_     = nullptr;
+    }
+    return *this;
+}
+
+CachedStatement::~CachedStatement()
+{
+    release();
+}
+
+sqlite3_stmt* CachedStatement::get() const
+{
+    return statement_;
+}
+
+void CachedStatement::release()
+{
+    if (cache_) {
+        cache_->release(statement_, entry_);
+    }
+    cache_     = nullptr;
+    statement_ = nullptr;
+    entry_     = nullptr;
+}
+
+bool CachedStatement::step()
+{
+    int result = sqlite3_step(statement_);
+
+    if (result == SQLITE_ROW) {
+        return true;
+    }
+
+    if (result != SQLITE_DONE) {
+        throw exception::SqliteException("Error executing statement: " + std::string(sqlite3_errmsg(sqlite3_db_handle(statement_))));
+    }
+    return false;
+}
+
+void CachedStatement::reset()
+{
+    sqlite3_reset(statement_);
+    sqlite3_clear_bindings(statement_);
+}
+
+void CachedStatement::bind(int index, int64_t value)
+{
+    sqlite3_bind_int64(statement_, index, value);
+}
+
+void CachedStatement::bind(int index, double value)
+{
+    sqlite3_bind_double(statement_, index, value);
+}
+
+void CachedStatement::bind(int index, std::string_view value, bool copy)
+{
+    sqlite3_bind_text64(statement_, index, value.data(), value.size(), copy ? SQLITE_TRANSIENT : SQLITE_STATIC, SQLITE_UTF8);
+}
+
+void CachedStatement::bind(int index, SqliteBlobView value, bool copy)
+{
+    // sqlite3_bind_blob64 binds NULL for a null pointer, which an empty std::vector may hand out
+    if (value.size == 0) {
+        sqlite3_bind_zeroblob64(statement_, index, 0);
+        return;
+    }
+    sqlite3_bind_blob64(statement_, index, value.data, value.size, copy ? SQLITE_TRANSIENT : SQLITE_STATIC);
+}
+
+void CachedStatement::bind(int index, SqliteZeroBlob value)
+{
+    sqlite3_bind_zeroblob64(statement_, index, value.size);
+}
+
+void CachedStatement::bindNull(int index)
+{
+    sqlite3_bind_null(statement_, index);
+}
+
+int CachedStatement::columnCount() const
+{
+    return sqlite3_column_count(statement_);
+}
+
+std::string_view CachedStatement::columnName(int index) const
+{
+    return sqlite3_column_name(statement_, index);
+}
+
+bool CachedStatement::isNull(int index) const
+{
+    return sqlite3_column_type(statement_, index) == SQLITE_NULL;
+}
+
+int64_t CachedStatement::columnInt64(int index) const
+{
+    return sqlite3_column_int64(statement_, index);
+}
+
+double CachedStatement::columnDouble(int index) const
+{
+    return sqlite3_column_double(statement_, index);
+}
+
+std::string_view CachedStatement::columnText(int index) const
+{
+    const auto text = reinterpret_cast<const char*>(sqlite3_column_text(statement_, index));
+    return std::string_view(text ? text : "", sqlite3_column_bytes(statement_, index));
+}
+
+SqliteBlobView CachedStatement::columnBlob(int index) const
+{
+    const auto data = static_cast<const std::byte*>(sqlite3_column_blob(statement_, index));
+    return SqliteBlobView{ data, static_cast<size_t>(sqlite3_column_bytes(statement_, index)) };
+}
+
+StatementCache::StatementCache(sqlite3* database, size_t capacity) : database_(database), capacity_(capacity)
+{
+}
+
+StatementCache::~StatementCache()
+{
+    clear();
+}
+
+CachedStatement StatementCache::acquire(std::string_view sql)
+{
+    auto found = index_.find(sql);
+
+    if (found != index_.end() && !found->second->in_use) {
+        ++hits_;
+        entries_.splice(entries_.begin(), entries_, found->second);
+        auto& entry  = *found->second;
+        entry.in_use = true;
+        return CachedStatement(this, entry.statement, &entry);
+    }
+
+    ++misses_;
+
+    if (plan_warning_handler_) {
+        inspectPlan(sql);
+    }
+
+    // The cached statement is still stepping (e.g. a nested query of the same shape), so hand out a private one.
+    if (found != index_.end() || capacity_ == 0) {
+        return CachedStatement(this, prepare(sql, 0), nullptr);
+    }
+
+    entries_.push_front(Entry{ std::string(sql), prepare(sql, SQLITE_PREPARE_PERSISTENT), true });
+    auto& entry = entries_.front();
+    index_.emplace(entry.sql, entries_.begin());
+    evictOverflow();
+
+    return CachedStatement(this, entry.statement, &entry);
+}
+
+void StatementCache::setCapacity(size_t capacity)
+{
+    capacity_ = capacity;
+    evictOverflow();
+}
+
+StatementCacheStats StatementCache::stats() const
+{
+    return StatementCacheStats{ hits_, misses_, evictions_, entries_.size(), capacity_ };
+}
+
+void StatementCache::clear()
+{
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        if (it->in_use) {
+            ++it;
+            continue;
+        }
+        index_.erase(it->sql);
+        sqlite3_finalize(it->statement);
+        it = entries_.erase(it);
+    }
+}
+
+void StatementCache::setPlanInspection(QueryPlanWarningHandler handler)
+{
+    plan_warning_handler_ = std::move(handler);
+}
+
+void StatementCache::setTraceConnection(uint64_t connection)
+{
+    trace_connection_ = connection;
+}
+
+sqlite3_stmt* StatementCache::prepare(std::string_view sql, unsigned int flags) const
+{
+    sqlite3_stmt* statement = nullptr;
+
+    const char* tail    = nullptr;
+    const auto  started = trace_connection_ != 0 ? trace::now() : 0;
+    int         result  = sqlite3_prepare_v3(database_, sql.data(), static_cast<int>(sql.size()), flags, &statement, &tail);
+    if (trace_connection_ != 0) {
+        trace::record("prepare", "sqlite", started, trace::now(), trace_connection_, sql);
+    }
+    if (result != SQLITE_OK) {
+        sqlite3_finalize(statement);
+        throw exception::SqliteException("Failed to prepare statement: " + std::string(sqlite3_errmsg(database_)));
+    }
+
+    // Only the first statement would ever run, so anything but whitespace and comments after it is an error
+    const auto rest = sql.substr(static_cast<size_t>(tail - sql.data()));
+    if (rest.find_first_not_of(" \t\r\n") != std::string_view::npos) {
+        sqlite3_stmt* next        = nullptr;
+        const int     rest_result = sqlite3_prepare_v3(database_, rest.data(), static_cast<int>(rest.size()), 0, &next, nullptr);
+        if (rest_result != SQLITE_OK || next != nullptr) {
+            sqlite3_finalize(next);
+            sqlite3_finalize(statement);
+            throw exception::SqliteException("Cannot prepare more than one statement: " + std::string(sql));
+        }
+    }
+
+    return statement;
+}
+
+void StatementCache::inspectPlan(std::string_view sql)
+{
+    // Evicted statements are prepared again, their plan is only reported once
+    if (inspected_shapes_.count(std::string(sql)) != 0) {
+        return;
+    }
+
+    QueryPlan plan;
+    try {
+        plan = explainQueryPlan(database_, sql);
+    } catch (const exception::SqliteException&) {
+        // Invalid SQL is reported by the prepare that follows
+        return;
+    }
+
+    for (const auto& warning : plan.warnings()) {
+        plan_warning_handler_(warning);
+    }
+
+    // Only once the handler accepted every warning: a handler that throws fails each acquire of the shape
+    inspected_shapes_.emplace(sql);
+}
+
+void StatementCache::release(sqlite3_stmt* statement, Entry* entry)
+{
+    if (entry == nullptr) {
+        sqlite3_finalize(statement);
+        return;
+    }
+
+    sqlite3_reset(statement);
+    sqlite3_clear_bindings(statement);
+    entry->in_use = false;
+
+    evictOverflow();
+}
+
+void StatementCache::evictOverflow()
+{
+    auto it = entries_.end();
+    while (entries_.size() > capacity_ && it != entries_.begin()) {
+        --it;
+        if (it->in_use) {
+            continue;
+        }
+        index_.erase(it->sql);
+        sqlite3_finalize(it->statement);
+        it = entries_.erase(it);
+        ++evictions_;
+    }
+}
+
+}// namespace sqlitecpp
@@ -0,0 +1,259 @@
+#include "StatementStats.hpp"
+
+#include <algorithm>
+#include <cctype>
+
+#include "../sqlite/sqlite3.h"
+
+namespace sqlitecpp {
+
+namespace {
+
+bool isIdentifierChar(char c)
+{
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '$' || static_cast<unsigned char>(c) >= 0x80;
+}
+
+size_t skipQuoted(std::string_view sql, size_t position, char close)
+{
+    // Doubled closing quotes are escapes, e.g. 'it''s'
+    for (++position; position < sql.size(); ++position) {
+        if (sql[position] == close) {
+            if (position + 1 < sql.size() && sql[position + 1] == close) {
+                ++position;
+                continue;
+            }
+            return position + 1;
+        }
+    }
+    return sql.size();
+}
+
+size_t skipNumber(std::string_view sql, size_t position)
+{
+    if (sql.compare(position, 2, "0x") == 0 || sql.compare(position, 2, "0X") == 0) {
+        position += 2;
+        while (position < sql.size() && std::isxdigit(static_cast<unsigned char>(sql[position]))) {
+            ++position;
+        }
+        return position;
+    }
+
+    while (position < sql.size()) {
+        const char c = sql[position];
+        if (std::isdigit(static_cast<unsigned char>(c)) || c == '.') {
+            ++position;
+        } else if ((c == 'e' || c == 'E') && position + 1 < sql.size()) {
+            position += (sql[position + 1] == '+' || sql[position + 1] == '-') ? 2 : 1;
+        } else {
+            break;
+        }
+    }
+    return position;
+}
+
+// "VALUES (?, ?), (?, ?), (?, ?)" becomes "VALUES (?, ?), ..." so batches of any size share a fingerprint
+std::string foldRepeatedGroups(std::string text)
+{
+    size_t search_from = 0;
+
+    while (true) {
+        const auto open = text.find('(', search_from);
+        if (open == std::string::npos) {
+            return text;
+        }
+
+        const auto close = text.find(')', open);
+        if (close == std::string::npos) {
+            return text;
+        }
+
+        const auto group = text.substr(open, close - open + 1);
+        const auto next  = ", " + group;
+        auto       end   = close + 1;
+        while (text.compare(end, next.size(), next) == 0) {
+            end += next.size();
+        }
+
+        if (end != close + 1) {
+            text.replace(close + 1, end - close - 1, ", ...");
+        }
+        search_from = open + 1;
+    }
+}
+
+}// namespace
+
+std::chrono::nanoseconds StatementStatsEntry::meanTime() const
+{
+    return calls > 0 ? total_time / static_cast<int64_t>(calls) : std::chrono::nanoseconds(0);
+}
+
+std::string StatementStats::fingerprint(std::string_view sql)
+{
+    std::string result;
+    result.reserve(sql.size());
+
+    // Tokens are separated by single spaces, except inside parentheses and around "," "." ";", so
+    // "a=1" and "a = 1" or "f( x ,y )" and "f(x, y)" share a fingerprint
+    bool   had_space = false;
+    size_t position  = 0;
+
+    const auto append = [&](std::string_view token, bool spaced) {
+        if (spaced && !result.empty() && result.back() != '(' && result.back() != '.') {
+            result += ' ';
+        }
+        result += token;
+        had_space = false;
+    };
+
+    while (position < sql.size()) {
+        const char c = sql[position];
+
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            had_space = true;
+            ++position;
+        } else if (sql.compare(position, 2, "--") == 0) {
+            const auto end = sql.find('\n', position);
+            position       = end == std::string_view::npos ? sql.size() : end;
+            had_space      = true;
+        } else if (sql.compare(position, 2, "/*") == 0) {
+            const auto end = sql.find("*/", position + 2);
+            position       = end == std::string_view::npos ? sql.size() : end + 2;
+            had_space      = true;
+        } else if (c == '\'') {
+            append("?", true);
+            position = skipQuoted(sql, position, '\'');
+        } else if ((c == 'x' || c == 'X') && position + 1 < sql.size() && sql[position + 1] == '\''
+                   && (position == 0 || !isIdentifierChar(sql[position - 1]))) {
+            append("?", true);
+            position = skipQuoted(sql, position + 1, '\'');
+        } else if (c == '"' || c == '`' || c == '[') {
+            // Quoted identifiers are part of the shape
+            const auto end = c == '[' ? std::min(sql.find(']', position), sql.size() - 1) + 1 : skipQuoted(sql, position, c);
+            append(sql.substr(position, end - position), true);
+            position = end;
+        } else if (std::isdigit(static_cast<unsigned char>(c))
+                   || (c == '.' && position + 1 < sql.size() && std::isdigit(static_cast<unsigned char>(sql[position + 1])))) {
+            append("?", true);
+            position = skipNumber(sql, position);
+        } else if (c == '?' || c == ':' || c == '@' || c == '$') {
+            // Numbered and named parameters (?1, :name, @name, $name) all become ?
+            auto end = position + 1;
+            while (end < sql.size() && isIdentifierChar(sql[end])) {
+                ++end;
+            }
+            append("?", true);
+            position = end;
+        } else if (isIdentifierChar(c)) {
+            auto end = position + 1;
+            while (end < sql.size() && isIdentifierChar(sql[end])) {
+                ++end;
+            }
+            append(sql.substr(position, end - position), true);
+            position = end;
+        } else if (c == ',' || c == ')' || c == '.' || c == ';') {
+            append(std::string_view(&sql[position], 1), false);
+            ++position;
+        } else if (c == '(') {
+            // Keeps "count(*)" tight while "VALUES (" and "IN (" keep their space
+            append("(", had_space || (!result.empty() && result.back() == ','));
+            ++position;
+        } else {
+            // Operators, with multi-character ones such as <= and || kept together
+            auto end = position + 1;
+            while (end < sql.size() && std::string_view("<>=!|*/+-%&~").find(sql[end]) != std::string_view::npos
+                   && sql.compare(end, 2, "--") != 0 && sql.compare(end, 2, "/*") != 0) {
+                ++end;
+            }
+            append(sql.substr(position, end - position), true);
+            position = end;
+        }
+    }
+
+    while (!result.empty() && result.back() == ';') {
+        result.pop_back();
+    }
+
+    return foldRepeatedGroups(std::move(result));
+}
+
+void StatementStats::onProfile(sqlite3_stmt* statement, int64_t elapsed_ns, uint64_t rows)
+{
+    const auto sql = sqlite3_sql(statement);
+    if (sql == nullptr) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto& entry = entryFor(sql);
+    ++entry.calls;
+
+    const std::chrono::nanoseconds elapsed(elapsed_ns);
+    entry.total_time += elapsed;
+    entry.max_time = std::max(entry.max_time, elapsed);
+    entry.rows += rows;
+
+    // Reading with the reset flag set turns the statement's running totals into per-execution values
+    entry.full_scan_steps += sqlite3_stmt_status(statement, SQLITE_STMTSTATUS_FULLSCAN_STEP, 1);
+    entry.sorts += sqlite3_stmt_status(statement, SQLITE_STMTSTATUS_SORT, 1);
+    entry.auto_indexes += sqlite3_stmt_status(statement, SQLITE_STMTSTATUS_AUTOINDEX, 1);
+    entry.vm_steps += sqlite3_stmt_status(statement, SQLITE_STMTSTATUS_VM_STEP, 1);
+}
+
+std::vector<StatementStatsEntry> StatementStats::top(size_t count) const
+{
+    std::vector<StatementStatsEntry> result;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        result.reserve(entries_.size());
+        for (const auto& [fingerprint, entry] : entries_) {
+            result.push_back(entry);
+        }
+    }
+
+    const auto by_total_time = [](const auto& lhs, const auto& rhs) { return lhs.total_time > rhs.total_time; };
+    if (count < result.size()) {
+        std::partial_sort(result.begin(), result.begin() + count, result.end(), by_total_time);
+        result.resize(count);
+    } else {
+        std::sort(result.begin(), result.end(), by_total_time);
+    }
+
+    return result;
+}
+
+void StatementStats::reset()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    texts_.clear();
+    text_storage_.clear();
+    entries_.clear();
+}
+
+StatementStatsEntry& StatementStats::entryFor(std::string_view sql)
+{
+    // Runs for every profiled execution, the lookup must not allocate
+    if (const auto found = texts_.find(sql); found != texts_.end()) {
+        return *found->second;
+    }
+
+    // Ad-hoc SQL with inline literals produces a new text per execution, so the text cache is bounded
+    if (texts_.size() >= MAX_CACHED_TEXTS) {
+        texts_.clear();
+        text_storage_.clear();
+    }
+
+    auto  key   = fingerprint(sql);
+    auto& entry = entries_[key];
+    if (entry.fingerprint.empty()) {
+        entry.fingerprint = std::move(key);
+    }
+
+    texts_.emplace(text_storage_.emplace_back(sql), &entry);
+    return entry;
+}
+
+}// namespace sqlitecpp
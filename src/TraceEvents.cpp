@@ -0,0 +1,205 @@
+#include "TraceEvents.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include "JsonEscape.hpp"
+#include "SqliteException.hpp"
+#include "ThreadSlots.hpp"
+
+namespace sqlitecpp::trace {
+
+namespace {
+
+struct Event
+{
+    const char* name       = nullptr;
+    const char* category   = nullptr;
+    int64_t     start_ns   = 0;
+    int64_t     end_ns     = 0;
+    uint64_t    connection = 0;
+    char        detail[DETAIL_SIZE]{};
+};
+
+/**
+ * Single writer ring. A slot's sequence is odd while its owner rewrites it, so a reader that sees the same even
+ * sequence before and after copying the event knows the copy is consistent.
+ */
+struct Ring
+{
+    struct Slot
+    {
+        std::atomic<uint32_t> sequence{ 0 };
+        Event                 event;
+    };
+
+    std::atomic<uint64_t>           next{ 0 };
+    std::atomic<uint64_t>           cleared{ 0 };// events before this index were dropped by clear()
+    std::array<Slot, RING_CAPACITY> slots;
+
+    void push(const Event& event)
+    {
+        const auto index    = next.load(std::memory_order_relaxed);
+        auto&      slot     = slots[index % RING_CAPACITY];
+        const auto sequence = slot.sequence.load(std::memory_order_relaxed);
+
+        slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.event = event;
+        slot.sequence.store(sequence + 2, std::memory_order_release);
+        next.store(index + 1, std::memory_order_release);
+    }
+
+    void collect(std::vector<Event>& events) const
+    {
+        const auto end   = next.load(std::memory_order_acquire);
+        const auto begin = std::max(end > RING_CAPACITY ? end - RING_CAPACITY : 0, cleared.load(std::memory_order_relaxed));
+
+        for (auto index = begin; index < end; ++index) {
+            const auto& slot   = slots[index % RING_CAPACITY];
+            const auto  before = slot.sequence.load(std::memory_order_acquire);
+            if (before % 2 != 0) {
+                continue;
+            }
+
+            const auto event = slot.event;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) == before) {
+                events.push_back(event);
+            }
+        }
+    }
+};
+
+// Rings of finished threads are reused like metric shards, so their events stay exportable
+using Rings = detail::ThreadSlots<Ring>;
+
+// Process start rather than first use, so now() never returns 0, which callers use as "not recording"
+const auto EPOCH = std::chrono::steady_clock::now();
+
+thread_local uint64_t current_connection = 0;
+
+// Cuts text to at most max_size bytes without splitting a UTF-8 sequence
+std::string_view truncateUtf8(std::string_view text, size_t max_size)
+{
+    if (text.size() <= max_size) {
+        return text;
+    }
+
+    // Back up over continuation bytes (10xxxxxx) to the lead byte of the sequence the cut would split
+    auto length = max_size;
+    while (length > 0 && (static_cast<unsigned char>(text[length]) & 0xc0) == 0x80) {
+        --length;
+    }
+    return text.substr(0, length);
+}
+
+void appendMicroseconds(std::string& out, int64_t nanoseconds)
+{
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.3f", static_cast<double>(nanoseconds) / 1000.0);
+    out += text;
+}
+
+}// namespace
+
+int64_t now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - EPOCH).count();
+}
+
+uint64_t nextConnectionId()
+{
+    static std::atomic<uint64_t> next_id{ 1 };
+    return next_id.fetch_add(1, std::memory_order_relaxed);
+}
+
+void setCurrentConnection(uint64_t connection)
+{
+    current_connection = connection;
+}
+
+uint64_t currentConnection()
+{
+    return current_connection;
+}
+
+void record(const char* name, const char* category, int64_t start_ns, int64_t end_ns, uint64_t connection, std::string_view detail)
+{
+    Event event;
+    event.name       = name;
+    event.category   = category;
+    event.start_ns   = start_ns;
+    event.end_ns     = end_ns;
+    event.connection = connection;
+
+    const auto kept = truncateUtf8(detail, DETAIL_SIZE - 1);
+    std::memcpy(event.detail, kept.data(), kept.size());
+    event.detail[kept.size()] = '\0';
+
+    Rings::local().push(event);
+}
+
+std::string toChromeJson()
+{
+    std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool        first = true;
+
+    std::vector<Event> events;
+    uint32_t           thread_index = 0;
+
+    // Rings are listed in creation order, so a ring keeps its tid across exports
+    Rings::forEach([&](const Ring& ring) {
+        events.clear();
+        ring.collect(events);
+
+        const auto tid = std::to_string(++thread_index);
+
+        json += first ? "\n" : ",\n";
+        first = false;
+        json += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + tid + ",\"args\":{\"name\":\"sqlitecpp " + tid + "\"}}";
+
+        for (const auto& event : events) {
+            json += ",\n{\"name\":\"";
+            json += event.name;
+            json += "\",\"cat\":\"";
+            json += event.category;
+            json += "\",\"ph\":\"X\",\"pid\":1,\"tid\":" + tid + ",\"ts\":";
+            appendMicroseconds(json, event.start_ns);
+            json += ",\"dur\":";
+            appendMicroseconds(json, event.end_ns - event.start_ns);
+            json += ",\"args\":{\"connection\":" + std::to_string(event.connection);
+            if (event.detail[0] != '\0') {
+                json += ",\"detail\":\"";
+                detail::appendJsonEscaped(json, event.detail);
+                json += "\"";
+            }
+            json += "}}";
+        }
+    });
+
+    json += "\n]}\n";
+    return json;
+}
+
+void writeChromeTrace(const std::filesystem::path& path)
+{
+    std::ofstream file(path, std::ios::trunc);
+    file << toChromeJson();
+    if (!file) {
+        throw exception::SqliteException("Failed to write trace to " + path.string());
+    }
+}
+
+void clear()
+{
+    Rings::forEach([](Ring& ring) { ring.cleared.store(ring.next.load(std::memory_order_acquire), std::memory_order_relaxed); });
+}
+
+}// namespace sqlitecpp::trace
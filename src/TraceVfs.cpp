@@ -0,0 +1,201 @@
+#include "TraceEvents.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "../sqlite/sqlite3.h"
+
+namespace sqlitecpp::trace {
+
+namespace {
+
+// The default VFS's file object is allocated directly behind this header
+struct TracedFile
+{
+    sqlite3_file  base;
+    sqlite3_file* real;
+    const char*   name;// file name as passed to xOpen, valid until xClose; null for temporary files
+};
+
+sqlite3_vfs* real_vfs = nullptr;
+
+sqlite3_file* realFile(sqlite3_file* file)
+{
+    return reinterpret_cast<TracedFile*>(file)->real;
+}
+
+int tracedClose(sqlite3_file* file)
+{
+    auto real   = realFile(file);
+    int  result = real->pMethods->xClose(real);
+    file->pMethods = nullptr;
+    return result;
+}
+
+int tracedRead(sqlite3_file* file, void* buffer, int amount, sqlite3_int64 offset)
+{
+    auto real = realFile(file);
+    return real->pMethods->xRead(real, buffer, amount, offset);
+}
+
+int tracedWrite(sqlite3_file* file, const void* buffer, int amount, sqlite3_int64 offset)
+{
+    auto real = realFile(file);
+    return real->pMethods->xWrite(real, buffer, amount, offset);
+}
+
+int tracedTruncate(sqlite3_file* file, sqlite3_int64 size)
+{
+    auto real = realFile(file);
+    return real->pMethods->xTruncate(real, size);
+}
+
+int tracedSync(sqlite3_file* file, int flags)
+{
+    const auto traced  = reinterpret_cast<TracedFile*>(file);
+    const auto started = now();
+    const int  result  = traced->real->pMethods->xSync(traced->real, flags);
+
+    const char* name = traced->name ? traced->name : "temporary file";
+    if (const auto slash = std::strrchr(name, '/')) {
+        name = slash + 1;
+    }
+    record("fsync", "io", started, now(), currentConnection(), name);
+
+    return result;
+}
+
+int tracedFileSize(sqlite3_file* file, sqlite3_int64* size)
+{
+    auto real = realFile(file);
+    return real->pMethods->xFileSize(real, size);
+}
+
+int tracedLock(sqlite3_file* file, int lock)
+{
+    auto real = realFile(file);
+    return real->pMethods->xLock(real, lock);
+}
+
+int tracedUnlock(sqlite3_file* file, int lock)
+{
+    auto real = realFile(file);
+    return real->pMethods->xUnlock(real, lock);
+}
+
+int tracedCheckReservedLock(sqlite3_file* file, int* reserved)
+{
+    auto real = realFile(file);
+    return real->pMethods->xCheckReservedLock(real, reserved);
+}
+
+int tracedFileControl(sqlite3_file* file, int operation, void* argument)
+{
+    auto real = realFile(file);
+    return real->pMethods->xFileControl(real, operation, argument);
+}
+
+int tracedSectorSize(sqlite3_file* file)
+{
+    auto real = realFile(file);
+    return real->pMethods->xSectorSize(real);
+}
+
+int tracedDeviceCharacteristics(sqlite3_file* file)
+{
+    auto real = realFile(file);
+    return real->pMethods->xDeviceCharacteristics(real);
+}
+
+int tracedShmMap(sqlite3_file* file, int region, int size, int extend, void volatile** memory)
+{
+    auto real = realFile(file);
+    return real->pMethods->xShmMap(real, region, size, extend, memory);
+}
+
+int tracedShmLock(sqlite3_file* file, int offset, int count, int flags)
+{
+    auto real = realFile(file);
+    return real->pMethods->xShmLock(real, offset, count, flags);
+}
+
+void tracedShmBarrier(sqlite3_file* file)
+{
+    auto real = realFile(file);
+    real->pMethods->xShmBarrier(real);
+}
+
+int tracedShmUnmap(sqlite3_file* file, int delete_flag)
+{
+    auto real = realFile(file);
+    return real->pMethods->xShmUnmap(real, delete_flag);
+}
+
+int tracedFetch(sqlite3_file* file, sqlite3_int64 offset, int amount, void** page)
+{
+    auto real = realFile(file);
+    return real->pMethods->xFetch(real, offset, amount, page);
+}
+
+int tracedUnfetch(sqlite3_file* file, sqlite3_int64 offset, void* page)
+{
+    auto real = realFile(file);
+    return real->pMethods->xUnfetch(real, offset, page);
+}
+
+// One table per io_methods version, so SQLite sees exactly the capabilities of the wrapped file
+const sqlite3_io_methods TRACED_METHODS[] = {
+    { 1, tracedClose, tracedRead, tracedWrite, tracedTruncate, tracedSync, tracedFileSize, tracedLock, tracedUnlock,
+      tracedCheckReservedLock, tracedFileControl, tracedSectorSize, tracedDeviceCharacteristics, nullptr, nullptr,
+      nullptr, nullptr, nullptr, nullptr },
+    { 2, tracedClose, tracedRead, tracedWrite, tracedTruncate, tracedSync, tracedFileSize, tracedLock, tracedUnlock,
+      tracedCheckReservedLock, tracedFileControl, tracedSectorSize, tracedDeviceCharacteristics, tracedShmMap,
+      tracedShmLock, tracedShmBarrier, tracedShmUnmap, nullptr, nullptr },
+    { 3, tracedClose, tracedRead, tracedWrite, tracedTruncate, tracedSync, tracedFileSize, tracedLock, tracedUnlock,
+      tracedCheckReservedLock, tracedFileControl, tracedSectorSize, tracedDeviceCharacteristics, tracedShmMap,
+      tracedShmLock, tracedShmBarrier, tracedShmUnmap, tracedFetch, tracedUnfetch },
+};
+
+int tracedOpen(sqlite3_vfs*, const char* name, sqlite3_file* file, int flags, int* out_flags)
+{
+    auto traced  = reinterpret_cast<TracedFile*>(file);
+    traced->real = reinterpret_cast<sqlite3_file*>(traced + 1);
+    traced->name = name;
+
+    const int result = real_vfs->xOpen(real_vfs, name, traced->real, flags, out_flags);
+
+    // SQLite only calls xClose when pMethods is set, which the wrapped VFS may do even on failure
+    if (traced->real->pMethods == nullptr) {
+        file->pMethods = nullptr;
+    } else {
+        const auto version = std::min(std::max(traced->real->pMethods->iVersion, 1), 3);
+        file->pMethods     = &TRACED_METHODS[version - 1];
+    }
+
+    return result;
+}
+
+sqlite3_vfs* registerVfs()
+{
+    real_vfs = sqlite3_vfs_find(nullptr);
+
+    // Everything but xOpen is the default VFS's own implementation, which only reads fields copied along
+    static sqlite3_vfs vfs = *real_vfs;
+    vfs.zName              = "sqlitecpp-trace";
+    vfs.pNext              = nullptr;
+    vfs.szOsFile           = static_cast<int>(sizeof(TracedFile)) + real_vfs->szOsFile;
+    vfs.xOpen              = tracedOpen;
+
+    sqlite3_vfs_register(&vfs, 0);
+    return &vfs;
+}
+
+}// namespace
+
+const char* vfsName()
+{
+    static const auto vfs = registerVfs();
+    return vfs->zName;
+}
+
+}// namespace sqlitecpp::trace
@@ -0,0 +1,91 @@
+#include "Transaction.hpp"
+
+#include "SqliteCpp.hpp"
+#include "SqliteException.hpp"
+#include "TraceEvents.hpp"
+
+namespace sqlitecpp {
+
+Transaction::Transaction(SqliteCpp& database, TransactionMode mode)
+    : database_(&database),
+      depth_(database.beginTransaction(mode)),
+      trace_started_ns_(database.traceConnection() != 0 ? trace::now() : 0)
+{
+}
+
+Transaction::Transaction(Transaction&& other) noexcept
+    : database_(other.database_), depth_(other.depth_), stopwatch_(other.stopwatch_), trace_started_ns_(other.trace_started_ns_)
+{
+    other.database_ = nullptr;
+}
+
+Transaction::~Transaction()
+{
+    if (!isActive()) {
+        return;
+    }
+
+    try {
+        rollback();
+    } catch (exception::SqliteException&) {
+        // Nothing sensible left to do while unwinding, SQLite discards the transaction when the connection closes
+    }
+}
+
+void Transaction::commit()
+{
+    guardInnermost();
+
+    // Stays armed until COMMIT succeeded, so a failed commit (e.g. SQLITE_BUSY) is still rolled back
+    auto database = database_;
+    database->commit(depth_);
+    database_ = nullptr;
+
+    if (trace_started_ns_ != 0) {
+        trace::record(isNested() ? "savepoint" : "transaction", "transaction", trace_started_ns_, trace::now(), database->traceConnection(), "commit");
+    }
+
+    if constexpr (metrics::ENABLED) {
+        metrics::record(metrics::Operation::Transaction, stopwatch_.elapsed(), false, 0, 0);
+    }
+}
+
+void Transaction::rollback()
+{
+    guardInnermost();
+
+    auto database = database_;
+    database_     = nullptr;
+
+    if constexpr (metrics::ENABLED) {
+        metrics::record(metrics::Operation::Transaction, stopwatch_.elapsed(), true, 0, 0);
+    }
+    database->rollback(depth_);
+
+    if (trace_started_ns_ != 0) {
+        trace::record(isNested() ? "savepoint" : "transaction", "transaction", trace_started_ns_, trace::now(), database->traceConnection(), "rollback");
+    }
+}
+
+bool Transaction::isActive() const
+{
+    return database_ != nullptr;
+}
+
+bool Transaction::isNested() const
+{
+    return depth_ > 0;
+}
+
+void Transaction::guardInnermost() const
+{
+    if (!isActive()) {
+        throw exception::SqliteException("Transaction is no longer active");
+    }
+
+    if (database_->transaction_depth_ != depth_ + 1) {
+        throw exception::SqliteException("Only the innermost transaction can be committed or rolled back");
+    }
+}
+
+}// namespace sqlitecpp
@@ -0,0 +1,116 @@
+#include "SqliteCpp.hpp"
+#include "TestSupport.hpp"
+
+using namespace sqlitecpp;
+
+namespace {
+
+constexpr int ROW_COUNT = 100;
+
+const char* const LOWER_NAMES =
+    "UPDATE items SET lower_name = lower(name), runs = runs + 1 WHERE rowid BETWEEN ?1 AND ?2";
+
+SqliteCpp openItems(const std::filesystem::path& db_path)
+{
+    auto database = SqliteCpp::createOrOpenDatabase(db_path);
+    database.runMigrations({ Migration(
+        "create items",
+        "CREATE TABLE items (id INTEGER PRIMARY KEY, name TEXT, lower_name TEXT CHECK (lower_name <> 'broken'),"
+        " runs INTEGER NOT NULL DEFAULT 0);") });
+
+    std::vector<std::map<std::string, SqliteData>> rows;
+    for (int id = 1; id <= ROW_COUNT; ++id) {
+        rows.push_back({ { "id", id }, { "name", "Item " + std::to_string(id) } });
+    }
+    database.upsertMany("items", rows);
+    return database;
+}
+
+BackfillMigration lowerNames(int64_t chunk_size = 10)
+{
+    BackfillOptions options;
+    options.chunk_size = chunk_size;
+    options.duty_cycle = 1;// no pauses between chunks
+    return BackfillMigration("lower names", "items", LOWER_NAMES, options);
+}
+
+// Number of rows the backfill statement ran on exactly once
+size_t rowsFilledOnce(const SqliteCpp& database)
+{
+    return database.selectFromTableWhere("items", { "id" }, { { "runs", 1 } }).size();
+}
+
+std::optional<SqliteRow> progressRow(const SqliteCpp& database, const std::string& title)
+{
+    const auto rows = database.selectFromTableWhere("sqlitecpp_backfills", { "progress" }, { { "title", title } });
+    return rows.empty() ? std::nullopt : std::optional<SqliteRow>(rows.front());
+}
+
+void fillsEveryRowOnce(const std::filesystem::path& db_path)
+{
+    auto database = openItems(db_path);
+
+    database.runBackfills({ lowerNames() });
+    SQLITECPP_CHECK(rowsFilledOnce(database) == ROW_COUNT);
+    const auto item = database.selectFromTableWhere("items", { "id" }, { { "lower_name", std::string("item 42") } });
+    SQLITECPP_CHECK(item.size() == 1);
+
+    // Finished backfills keep a NULL progress and are not run again
+    const auto progress = progressRow(database, "lower names");
+    SQLITECPP_CHECK(progress && std::holds_alternative<std::nullptr_t>(progress->cell(0)));
+    database.runBackfills({ lowerNames() });
+    SQLITECPP_CHECK(rowsFilledOnce(database) == ROW_COUNT);
+}
+
+void resumesAfterTheLastCommittedChunk(const std::filesystem::path& db_path)
+{
+    auto database = openItems(db_path);
+
+    // Row 60 violates the CHECK constraint, so the run stops in the chunk that contains it
+    database.upsert("items", { { "id", 60 }, { "name", std::string("BROKEN") } });
+    SQLITECPP_CHECK_THROWS(database.runBackfills({ lowerNames() }));
+
+    const auto progress = progressRow(database, "lower names");
+    SQLITECPP_CHECK(progress.has_value());
+    const auto committed = progress->get<int64_t>(0);
+    SQLITECPP_CHECK(committed > 0 && committed < 60);
+    SQLITECPP_CHECK(rowsFilledOnce(database) == static_cast<size_t>(committed));
+
+    // After fixing the row, the rerun starts after the stored progress and does not touch earlier rows again
+    database.upsert("items", { { "id", 60 }, { "name", std::string("Item 60") } });
+    database.runBackfills({ lowerNames() });
+    SQLITECPP_CHECK(rowsFilledOnce(database) == ROW_COUNT);
+}
+
+void keepsTitlesApartFromMigrations(const std::filesystem::path& db_path)
+{
+    auto database = openItems(db_path);
+
+    database.runMigrations({ Migration("lower names", "CREATE TABLE audit (id INTEGER PRIMARY KEY);") });
+    database.runBackfills({ lowerNames() });
+
+    SQLITECPP_CHECK(database.selectStarFromTable("audit").empty());
+    SQLITECPP_CHECK(rowsFilledOnce(database) == ROW_COUNT);
+}
+
+void refusesToRunInsideATransaction(const std::filesystem::path& db_path)
+{
+    auto database = openItems(db_path);
+
+    auto transaction = database.transaction();
+    SQLITECPP_CHECK_THROWS(database.runBackfills({ lowerNames() }));
+    transaction.rollback();
+    SQLITECPP_CHECK(rowsFilledOnce(database) == 0);
+}
+
+}// namespace
+
+int main()
+{
+    return test::runAll({
+        { "fillsEveryRowOnce", fillsEveryRowOnce },
+        { "resumesAfterTheLastCommittedChunk", resumesAfterTheLastCommittedChunk },
+        { "keepsTitlesApartFromMigrations", keepsTitlesApartFromMigrations },
+        { "refusesToRunInsideATransaction", refusesToRunInsideATransaction },
+    });
+}
@@ -0,0 +1,90 @@
+#include "SqliteCpp.hpp"
+#include "TestSupport.hpp"
+
+using namespace sqlitecpp;
+
+namespace {
+
+std::vector<Migration> baseMigrations()
+{
+    return {
+        Migration("create users", "CREATE TABLE users (id INTEGER PRIMARY KEY, name TEXT);"),
+        Migration("create posts", "CREATE TABLE posts (id INTEGER PRIMARY KEY, user_id INTEGER, body TEXT);"),
+    };
+}
+
+size_t appliedCount(const SqliteCpp& database)
+{
+    return database.selectStarFromTable("sqlitecpp_migrations").size();
+}
+
+int64_t userVersion(const SqliteCpp& database)
+{
+    return database.selectStarFromTable("pragma_user_version").at(0).get<int64_t>(0);
+}
+
+void appliesEachMigrationOnce(const std::filesystem::path& db_path)
+{
+    {
+        auto database = SqliteCpp::createOrOpenDatabase(db_path);
+        database.runMigrations(baseMigrations());
+        database.runMigrations(baseMigrations());
+        SQLITECPP_CHECK(appliedCount(database) == 2);
+    }
+
+    // Reopened with one more migration, only the new one runs
+    auto migrations = baseMigrations();
+    migrations.emplace_back("create tags", "CREATE TABLE tags (name TEXT PRIMARY KEY);");
+
+    auto database = SqliteCpp::openDatabase(db_path);
+    database.runMigrations(migrations);
+    SQLITECPP_CHECK(appliedCount(database) == 3);
+    SQLITECPP_CHECK(database.selectStarFromTable("tags").empty());
+}
+
+void skipsTheAppliedSetWhenTheHashMatches(const std::filesystem::path& db_path)
+{
+    auto database = SqliteCpp::createOrOpenDatabase(db_path);
+    database.runMigrations(baseMigrations());
+    SQLITECPP_CHECK(
+        database.selectFromTableWhere("sqlitecpp_meta", { "value" }, { { "key", std::string("migrations_hash") } }).size()
+        == 1);
+
+    // With the record gone, only the stored hash keeps "create posts" from running again and failing
+    database.deleteFrom("sqlitecpp_migrations", { { "title", std::string("create posts") } });
+    database.runMigrations(baseMigrations());
+    SQLITECPP_CHECK(appliedCount(database) == 1);
+
+    // A different list misses the hash and falls back to the applied set
+    auto migrations = baseMigrations();
+    migrations.pop_back();
+    database.runMigrations(migrations);
+    SQLITECPP_CHECK_THROWS(database.runMigrations(baseMigrations()));
+}
+
+void leavesUserVersionToTheApplication(const std::filesystem::path& db_path)
+{
+    auto migrations = baseMigrations();
+    migrations.emplace_back("set user_version", "PRAGMA user_version = 7;");
+
+    auto database = SqliteCpp::createOrOpenDatabase(db_path);
+    database.runMigrations(migrations);
+    SQLITECPP_CHECK(userVersion(database) == 7);
+
+    migrations.emplace_back("create tags", "CREATE TABLE tags (name TEXT PRIMARY KEY);");
+    database.runMigrations(migrations);
+    database.runMigrations(migrations);
+    SQLITECPP_CHECK(userVersion(database) == 7);
+    SQLITECPP_CHECK(appliedCount(database) == 4);
+}
+
+}// namespace
+
+int main()
+{
+    return test::runAll({
+        { "appliesEachMigrationOnce", appliesEachMigrationOnce },
+        { "skipsTheAppliedSetWhenTheHashMatches", skipsTheAppliedSetWhenTheHashMatches },
+        { "leavesUserVersionToTheApplication", leavesUserVersionToTheApplication },
+    });
+}
@@ -0,0 +1,94 @@
+#include <stdexcept>
+
+#include "SqliteCpp.hpp"
+#include "TestSupport.hpp"
+
+using namespace sqlitecpp;
+
+namespace {
+
+const Migration CREATE_USERS(
+    "create users",
+    "CREATE TABLE users (id INTEGER PRIMARY KEY, name TEXT, email TEXT); CREATE INDEX users_email ON users (email);");
+
+SqliteCpp openUsers(const std::filesystem::path& db_path, QueryPlanWarningHandler handler)
+{
+    OpenOptions options;
+    options.inspect_query_plans = true;
+    options.query_plan_handler  = std::move(handler);
+
+    auto database = SqliteCpp::createOrOpenDatabase(db_path, options);
+    database.runMigrations({ CREATE_USERS });
+    return database;
+}
+
+void reportsEachUnindexedShapeOnce(const std::filesystem::path& db_path)
+{
+    std::vector<QueryPlanWarning> warnings;
+    auto database = openUsers(db_path, [&warnings](const QueryPlanWarning& warning) { warnings.push_back(warning); });
+
+    database.selectFromTableWhere("users", { "*" }, { { "id", 1 } });
+    database.selectFromTableWhere("users", { "*" }, { { "email", std::string("a@example.com") } });
+    SQLITECPP_CHECK(warnings.empty());
+
+    database.selectFromTableWhere("users", { "*" }, { { "name", std::string("Ada") } });
+    database.selectFromTableWhere("users", { "*" }, { { "name", std::string("Bob") } });
+    SQLITECPP_CHECK(warnings.size() == 1);
+    SQLITECPP_CHECK(warnings[0].issue == QueryPlanIssue::FullScan);
+    SQLITECPP_CHECK(warnings[0].detail.find("users") != std::string::npos);
+    SQLITECPP_CHECK(warnings[0].sql.find("name") != std::string::npos);
+}
+
+void throwingHandlerFailsEveryAttempt(const std::filesystem::path& db_path)
+{
+    auto database = openUsers(db_path, [](const QueryPlanWarning& warning) {
+        throw std::runtime_error("unexpected plan: " + warning.detail);
+    });
+
+    // The shape is only marked inspected once the handler returned, so a retry is not let through
+    for (int attempt = 0; attempt < 3; ++attempt) {
+        SQLITECPP_CHECK_THROWS(database.selectFromTableWhere("users", { "*" }, { { "name", std::string("Ada") } }));
+    }
+    database.selectFromTableWhere("users", { "*" }, { { "email", std::string("a@example.com") } });
+}
+
+void classifiesPlanLines(const std::filesystem::path& db_path)
+{
+    auto database = openUsers(db_path, [](const QueryPlanWarning&) {});
+
+    const auto sorted = database.explainQueryPlan("SELECT * FROM users ORDER BY name").warnings();
+    SQLITECPP_CHECK(sorted.size() == 2);
+    SQLITECPP_CHECK(sorted[0].issue == QueryPlanIssue::FullScan);
+    SQLITECPP_CHECK(sorted[1].issue == QueryPlanIssue::TempBTree);
+
+    SQLITECPP_CHECK(database.explainQueryPlan("SELECT email FROM users ORDER BY email").warnings().empty());
+
+    const auto plan = database.explainQueryPlan("SELECT * FROM users WHERE name = 'Ada'");
+    SQLITECPP_CHECK(plan.toString().find("SCAN") != std::string::npos);
+}
+
+void exemptsOnlyTheBareCount(const std::filesystem::path& db_path)
+{
+    auto database = openUsers(db_path, [](const QueryPlanWarning&) {});
+    // Without any index SQLite cannot count through a smaller covering index, the plan says "SCAN events"
+    database.runMigrations({ CREATE_USERS, Migration("create events", "CREATE TABLE events (kind TEXT);") });
+
+    SQLITECPP_CHECK(database.explainQueryPlan("SELECT count(*) FROM events").warnings().empty());
+    SQLITECPP_CHECK(database.explainQueryPlan("select COUNT( * ) from events;").warnings().empty());
+    SQLITECPP_CHECK(database.explainQueryPlan("SELECT count(*) FROM events WHERE kind = 'login'").warnings().size() == 1);
+
+    const auto nested = database.explainQueryPlan("SELECT (SELECT count(*) FROM events), name FROM users WHERE name = 'Ada'");
+    SQLITECPP_CHECK(nested.warnings().size() == 2);
+}
+
+}// namespace
+
+int main()
+{
+    return test::runAll({
+        { "reportsEachUnindexedShapeOnce", reportsEachUnindexedShapeOnce },
+        { "throwingHandlerFailsEveryAttempt", throwingHandlerFailsEveryAttempt },
+        { "classifiesPlanLines", classifiesPlanLines },
+        { "exemptsOnlyTheBareCount", exemptsOnlyTheBareCount },
+    });
+}
@@ -0,0 +1,126 @@
+#include "SqliteCpp.hpp"
+#include "TestSupport.hpp"
+
+using namespace sqlitecpp;
+
+namespace {
+
+enum class Role
+{
+    Reader = 1,
+    Admin  = 2,
+};
+
+struct User
+{
+    int64_t                    id = 0;
+    std::string                name;
+    std::optional<std::string> email;
+    double                     score = 0;
+    Role                       role  = Role::Reader;
+    std::vector<std::byte>     avatar;
+};
+
+// Same table, but name is read into a non-optional member
+struct UserName
+{
+    int64_t     id = 0;
+    std::string name;
+};
+
+}// namespace
+
+SQLITECPP_MAP(User, "users", id, name, email, score, role, avatar)
+SQLITECPP_MAP(UserName, "users", id, name)
+
+namespace {
+
+SqliteCpp openUsers(const std::filesystem::path& db_path)
+{
+    auto database = SqliteCpp::createOrOpenDatabase(db_path);
+    database.runMigrations({ Migration(
+        "create users",
+        "CREATE TABLE users (id INTEGER PRIMARY KEY, name TEXT, email TEXT, score REAL, role INTEGER, avatar BLOB);") });
+    return database;
+}
+
+void roundTripsEveryMemberType(const std::filesystem::path& db_path)
+{
+    auto database = openUsers(db_path);
+
+    const User ada{ 1, "Ada", "ada@example.com", 9.5, Role::Admin, { std::byte{ 0 }, std::byte{ 0xff } } };
+    const User bob{ 2, "Bob", std::nullopt, 1.25, Role::Reader, {} };
+    database.insert(ada);
+    database.insert(bob);
+
+    const auto users = database.select<User>();
+    SQLITECPP_CHECK(users.size() == 2);
+    SQLITECPP_CHECK(users[0].id == 1);
+    SQLITECPP_CHECK(users[0].name == "Ada");
+    SQLITECPP_CHECK(users[0].email == std::optional<std::string>("ada@example.com"));
+    SQLITECPP_CHECK(users[0].score == 9.5);
+    SQLITECPP_CHECK(users[0].role == Role::Admin);
+    SQLITECPP_CHECK(users[0].avatar == ada.avatar);
+    SQLITECPP_CHECK(!users[1].email.has_value());
+
+    // Mapped rows are plain rows for the rest of the API
+    const auto row = database.selectFromTableWhere("users", { "email", "role" }, { { "id", 1 } }).at(0);
+    SQLITECPP_CHECK(row.get<std::string>("email") == "ada@example.com");
+    SQLITECPP_CHECK(row.get<int64_t>("role") == 2);
+}
+
+void selectsWithWhereClauses(const std::filesystem::path& db_path)
+{
+    auto database = openUsers(db_path);
+
+    database.upsertMany(std::vector<User>{
+        { 1, "Ada", std::nullopt, 1, Role::Admin, {} },
+        { 2, "Bob", std::nullopt, 2, Role::Reader, {} },
+    });
+
+    const auto users = database.select<User>({ { "name", std::string("Bob") } });
+    SQLITECPP_CHECK(users.size() == 1);
+    SQLITECPP_CHECK(users[0].id == 2);
+}
+
+void upsertsOnConflict(const std::filesystem::path& db_path)
+{
+    auto database = openUsers(db_path);
+
+    database.insert(User{ 1, "Ada", "ada@example.com", 1, Role::Reader, {} });
+    database.upsertMany(
+        std::vector<User>{
+            { 1, "Ada", "ada@example.org", 2, Role::Admin, {} },
+            { 2, "Bob", std::nullopt, 3, Role::Reader, {} },
+        },
+        { "id" });
+
+    const auto users = database.select<User>();
+    SQLITECPP_CHECK(users.size() == 2);
+    SQLITECPP_CHECK(users[0].email == std::optional<std::string>("ada@example.org"));
+    SQLITECPP_CHECK(users[0].role == Role::Admin);
+}
+
+void throwsOnNullInNonOptionalMember(const std::filesystem::path& db_path)
+{
+    auto database = openUsers(db_path);
+
+    database.upsert("users", { { "id", 1 }, { "name", nullptr } });
+
+    SQLITECPP_CHECK_THROWS(database.select<UserName>());
+
+    database.upsert("users", { { "id", 1 }, { "name", std::string("Ada") } });
+    SQLITECPP_CHECK(database.select<UserName>().at(0).name == "Ada");
+}
+
+}// namespace
+
+int main()
+{
+    return test::runAll({
+        { "roundTripsEveryMemberType", roundTripsEveryMemberType },
+        { "selectsWithWhereClauses", selectsWithWhereClauses },
+        { "upsertsOnConflict", upsertsOnConflict },
+        { "throwsOnNullInNonOptionalMember", throwsOnNullInNonOptionalMember },
+    });
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace sqlitecpp::test {
+
+struct TestCase
+{
+    const char* name;
+    void (*run)(const std::filesystem::path& db_path);
+};
+
+struct CheckFailure : std::runtime_error
+{
+    using std::runtime_error::runtime_error;
+};
+
+inline void fail(const char* file, int line, const std::string& message)
+{
+    throw CheckFailure(std::string(file) + ":" + std::to_string(line) + ": " + message);
+}
+
+// Runs every case against its own fresh database file and returns the process exit code
+inline int runAll(const std::vector<TestCase>& cases)
+{
+    const auto directory = std::filesystem::temp_directory_path();
+    int        failed    = 0;
+
+    for (const auto& test_case : cases) {
+        const auto db_path = directory / (std::string("sqlitecpp_") + test_case.name + ".db");
+        std::filesystem::remove(db_path);
+
+        try {
+            test_case.run(db_path);
+            std::cout << "[ OK ] " << test_case.name << "\n";
+        } catch (const std::exception& e) {
+            std::cout << "[FAIL] " << test_case.name << ": " << e.what() << "\n";
+            ++failed;
+        }
+
+        for (const char* suffix : { "", "-wal", "-shm", "-journal" }) {
+            std::filesystem::remove(db_path.string() + suffix);
+        }
+    }
+    return failed == 0 ? 0 : 1;
+}
+
+}// namespace sqlitecpp::test
+
+#define SQLITECPP_CHECK(condition)                                                                                     \
+    do {                                                                                                               \
+        if (!(condition)) {                                                                                            \
+            sqlitecpp::test::fail(__FILE__, __LINE__, "check failed: " #condition);                                    \
+        }                                                                                                              \
+    } while (false)
+
+#define SQLITECPP_CHECK_THROWS(expression)                                                                             \
+    do {                                                                                                               \
+        bool threw = false;                                                                                            \
+        try {                                                                                                          \
+            expression;                                                                                                \
+        } catch (const sqlitecpp::test::CheckFailure&) {                                                               \
+            throw;                                                                                                     \
+        } catch (const std::exception&) {                                                                              \
+            threw = true;                                                                                              \
+        }                                                                                                              \
+        if (!threw) {                                                                                                  \
+            sqlitecpp::test::fail(__FILE__, __LINE__, "expected an exception from: " #expression);                     \
+        }                                                                                                              \
+    } while (false)
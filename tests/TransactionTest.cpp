@@ -0,0 +1,113 @@
+#include "SqliteCpp.hpp"
+#include "TestSupport.hpp"
+
+using namespace sqlitecpp;
+
+namespace {
+
+SqliteCpp openItems(const std::filesystem::path& db_path)
+{
+    auto database = SqliteCpp::createOrOpenDatabase(db_path);
+    database.runMigrations({ Migration("create items", "CREATE TABLE items (id INTEGER PRIMARY KEY, name TEXT);") });
+    return database;
+}
+
+void addItem(SqliteCpp& database, int id)
+{
+    database.upsert("items", { { "id", id }, { "name", "item " + std::to_string(id) } });
+}
+
+size_t itemCount(const SqliteCpp& database)
+{
+    return database.selectStarFromTable("items").size();
+}
+
+void commitIsVisibleToOtherConnections(const std::filesystem::path& db_path)
+{
+    auto database = openItems(db_path);
+    auto other    = SqliteCpp::openDatabase(db_path);
+
+    auto transaction = database.transaction(TransactionMode::Immediate);
+    addItem(database, 1);
+    addItem(database, 2);
+    SQLITECPP_CHECK(itemCount(other) == 0);
+
+    transaction.commit();
+    SQLITECPP_CHECK(!transaction.isActive());
+    SQLITECPP_CHECK(itemCount(other) == 2);
+}
+
+void rollsBackOnDestruction(const std::filesystem::path& db_path)
+{
+    auto database = openItems(db_path);
+
+    {
+        auto transaction = database.transaction();
+        addItem(database, 1);
+    }
+    SQLITECPP_CHECK(itemCount(database) == 0);
+}
+
+void savepointRollbackKeepsOuterWrites(const std::filesystem::path& db_path)
+{
+    auto database = openItems(db_path);
+
+    auto outer = database.transaction();
+    addItem(database, 1);
+    {
+        auto inner = database.transaction();
+        SQLITECPP_CHECK(inner.isNested());
+        addItem(database, 2);
+        inner.rollback();
+    }
+    addItem(database, 3);
+    outer.commit();
+
+    const auto rows = database.selectStarFromTable("items");
+    SQLITECPP_CHECK(rows.size() == 2);
+    SQLITECPP_CHECK(rows[0].get<int64_t>("id") == 1);
+    SQLITECPP_CHECK(rows[1].get<int64_t>("id") == 3);
+}
+
+void outerRollbackDiscardsReleasedSavepoints(const std::filesystem::path& db_path)
+{
+    auto database = openItems(db_path);
+
+    {
+        auto outer = database.transaction();
+        {
+            auto inner = database.transaction();
+            addItem(database, 1);
+            inner.commit();
+        }
+        outer.rollback();
+    }
+    SQLITECPP_CHECK(itemCount(database) == 0);
+}
+
+void onlyTheInnermostGuardCanFinish(const std::filesystem::path& db_path)
+{
+    auto database = openItems(db_path);
+
+    auto outer = database.transaction();
+    auto inner = database.transaction();
+    SQLITECPP_CHECK_THROWS(outer.commit());
+    SQLITECPP_CHECK_THROWS(outer.rollback());
+
+    inner.commit();
+    SQLITECPP_CHECK_THROWS(inner.commit());
+    outer.commit();
+}
+
+}// namespace
+
+int main()
+{
+    return test::runAll({
+        { "commitIsVisibleToOtherConnections", commitIsVisibleToOtherConnections },
+        { "rollsBackOnDestruction", rollsBackOnDestruction },
+        { "savepointRollbackKeepsOuterWrites", savepointRollbackKeepsOuterWrites },
+        { "outerRollbackDiscardsReleasedSavepoints", outerRollbackDiscardsReleasedSavepoints },
+        { "onlyTheInnermostGuardCanFinish", onlyTheInnermostGuardCanFinish },
+    });
+}
@@ -0,0 +1,85 @@
+#include "SqliteCpp.hpp"
+#include "TestSupport.hpp"
+
+using namespace sqlitecpp;
+
+namespace {
+
+SqliteCpp openUsers(const std::filesystem::path& db_path)
+{
+    auto database = SqliteCpp::createOrOpenDatabase(db_path);
+    database.runMigrations({
+        Migration("create users", "CREATE TABLE users (email TEXT PRIMARY KEY, name TEXT, visits INTEGER);"),
+        Migration(
+            "create sessions",
+            "CREATE TABLE sessions (id INTEGER PRIMARY KEY, email TEXT REFERENCES users (email) ON DELETE CASCADE);"),
+    });
+    database.upsert(
+        "users", { { "email", std::string("a@example.com") }, { "name", std::string("A") }, { "visits", 5 } });
+    database.upsert("sessions", { { "id", 1 }, { "email", std::string("a@example.com") } });
+    return database;
+}
+
+SqliteRow findUser(const SqliteCpp& database)
+{
+    const auto rows = database.selectFromTableWhere(
+        "users", { "rowid", "name", "visits" }, { { "email", std::string("a@example.com") } });
+    SQLITECPP_CHECK(rows.size() == 1);
+    return rows.front();
+}
+
+void updatesTheRowInPlace(const std::filesystem::path& db_path)
+{
+    auto       database = openUsers(db_path);
+    const auto rowid    = findUser(database).get<int64_t>("rowid");
+
+    database.upsert("users", { { "email", std::string("a@example.com") }, { "name", std::string("B") } }, { "email" });
+
+    const auto user = findUser(database);
+    SQLITECPP_CHECK(user.get<int64_t>("rowid") == rowid);
+    SQLITECPP_CHECK(user.get<std::string>("name") == "B");
+    // Columns missing from the data keep their value instead of becoming NULL
+    SQLITECPP_CHECK(user.get<int64_t>("visits") == 5);
+    // No delete, so the ON DELETE CASCADE of sessions does not fire
+    SQLITECPP_CHECK(database.selectStarFromTable("sessions").size() == 1);
+}
+
+void insertsMissingRows(const std::filesystem::path& db_path)
+{
+    auto database = openUsers(db_path);
+
+    database.upsertMany(
+        "users",
+        {
+            { { "email", std::string("a@example.com") }, { "name", std::string("B") } },
+            { { "email", std::string("c@example.com") }, { "name", std::string("C") } },
+        },
+        { "email" });
+
+    SQLITECPP_CHECK(database.selectStarFromTable("users").size() == 2);
+    SQLITECPP_CHECK(findUser(database).get<std::string>("name") == "B");
+}
+
+void replacesWithoutConflictColumns(const std::filesystem::path& db_path)
+{
+    auto database = openUsers(db_path);
+
+    // INSERT OR REPLACE deletes the old row: the unset column is NULL and the delete cascades
+    database.upsert("users", { { "email", std::string("a@example.com") }, { "name", std::string("B") } });
+
+    const auto user = findUser(database);
+    SQLITECPP_CHECK(user.get<std::string>("name") == "B");
+    SQLITECPP_CHECK(std::holds_alternative<std::nullptr_t>(user.cell("visits")));
+    SQLITECPP_CHECK(database.selectStarFromTable("sessions").empty());
+}
+
+}// namespace
+
+int main()
+{
+    return test::runAll({
+        { "updatesTheRowInPlace", updatesTheRowInPlace },
+        { "insertsMissingRows", insertsMissingRows },
+        { "replacesWithoutConflictColumns", replacesWithoutConflictColumns },
+    });
+}
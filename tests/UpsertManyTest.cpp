@@ -0,0 +1,82 @@
+#include "SqliteCpp.hpp"
+#include "TestSupport.hpp"
+
+using namespace sqlitecpp;
+
+namespace {
+
+SqliteCpp openItems(const std::filesystem::path& db_path)
+{
+    auto database = SqliteCpp::createOrOpenDatabase(db_path);
+    database.runMigrations({ Migration("create items", "CREATE TABLE items (id INTEGER PRIMARY KEY, name TEXT NOT NULL);") });
+    return database;
+}
+
+std::vector<std::map<std::string, SqliteData>> itemRows(int64_t first_id, size_t count)
+{
+    std::vector<std::map<std::string, SqliteData>> rows;
+    for (size_t i = 0; i < count; ++i) {
+        const auto id = first_id + static_cast<int64_t>(i);
+        rows.push_back({ { "id", id }, { "name", "item " + std::to_string(id) } });
+    }
+    return rows;
+}
+
+// More rows than fit in one statement, so the batch is split into full chunks and a shorter tail
+void writesEveryChunk(const std::filesystem::path& db_path)
+{
+    auto database = openItems(db_path);
+
+    database.upsertMany("items", itemRows(1, 1000));
+
+    const auto rows = database.selectStarFromTable("items");
+    SQLITECPP_CHECK(rows.size() == 1000);
+    SQLITECPP_CHECK(rows.front().get<std::string>("name") == "item 1");
+    SQLITECPP_CHECK(rows.back().get<std::string>("name") == "item 1000");
+}
+
+void rollsBackTheWholeBatchOnError(const std::filesystem::path& db_path)
+{
+    auto database = openItems(db_path);
+
+    // The NULL name fails in the last chunk, after earlier chunks were already stepped
+    auto rows = itemRows(1, 600);
+    rows.back()["name"] = nullptr;
+    SQLITECPP_CHECK_THROWS(database.upsertMany("items", rows));
+    SQLITECPP_CHECK(database.selectStarFromTable("items").empty());
+}
+
+void rejectsRowsWithDifferentColumns(const std::filesystem::path& db_path)
+{
+    auto database = openItems(db_path);
+
+    auto rows = itemRows(1, 3);
+    rows[1].erase("name");
+    SQLITECPP_CHECK_THROWS(database.upsertMany("items", rows));
+    SQLITECPP_CHECK(database.selectStarFromTable("items").empty());
+}
+
+void joinsTheCallersTransaction(const std::filesystem::path& db_path)
+{
+    auto database = openItems(db_path);
+
+    {
+        auto outer = database.transaction();
+        database.upsertMany("items", itemRows(1, 300));
+        SQLITECPP_CHECK(database.selectStarFromTable("items").size() == 300);
+        outer.rollback();
+    }
+    SQLITECPP_CHECK(database.selectStarFromTable("items").empty());
+}
+
+}// namespace
+
+int main()
+{
+    return test::runAll({
+        { "writesEveryChunk", writesEveryChunk },
+        { "rollsBackTheWholeBatchOnError", rollsBackTheWholeBatchOnError },
+        { "rejectsRowsWithDifferentColumns", rejectsRowsWithDifferentColumns },
+        { "joinsTheCallersTransaction", joinsTheCallersTransaction },
+    });
+}